@@ -0,0 +1,760 @@
+// Microbenchmarks for the indicator kernels, the trade simulator and a full OTT grid, on
+// synthetic random-walk data so no data files are needed. Prints a JSON report to diff
+// across commits:
+//
+//   bench [--sizes=10000,1000000,10000000] [--filter=substring] [--min-time=0.2]
+//         [--csv-max-bars=1000000] [--simd=scalar|avx2|avx512] [--out=report.json] [--check]
+//
+// Before timing anything, every SIMD kernel level this machine supports is checked for
+// bitwise agreement with the scalar kernels, the Bollinger bands for agreement within
+// BOLLINGER_MAX_ULPS with the per-window deviation, the trade simulator for identical trades and
+// metrics with the bar-by-bar reference backtest, and every strategy's incremental run for the
+// results of a full run; a mismatch fails the run. --check stops after the checks (ctest runs
+// it that way).
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "backtest_metrics.h"
+#include "backtester.h"
+#include "incremental_run.h"
+#include "indicator_plan.h"
+#include "indicator_store.h"
+#include "indicators.h"
+#include "numa_topology.h"
+#include "optimizers.h"
+#include "price_series.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+#include "trade_simulator.h"
+#include "walk_forward.h"
+
+struct BenchResult {
+    std::string name;
+    std::size_t bars;
+    std::size_t iterations;
+    double seconds;             // Per iteration
+    double combinations;        // Per iteration, 0 when not a grid benchmark
+};
+
+class BenchRunner {
+private:
+    std::string filter;
+    double min_time;
+    std::vector<BenchResult> results;
+
+public:
+    BenchRunner(const std::string& name_filter, double min_seconds) : filter(name_filter), min_time(min_seconds) {}
+
+    bool selected(const std::string& name) const { return filter.empty() || name.find(filter) != std::string::npos; }
+
+    // Time `body` after one warm-up call, repeating it until `min_time` has passed
+    void run(const std::string& name, std::size_t bars, double combinations, const std::function<void()>& body) {
+        if (!selected(name)) {
+            return;
+        }
+        body();
+
+        std::size_t iterations = 0;
+        double elapsed = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        while (iterations == 0 || (elapsed < min_time && iterations < 1000000)) {
+            body();
+            ++iterations;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        BenchResult result = {name, bars, iterations, elapsed / iterations, combinations};
+        std::cerr << name << ": " << result.seconds * 1e3 << " ms (" << iterations << " iterations)" << std::endl;
+        results.push_back(result);
+    }
+
+    void writeJson(std::ostream& out) const {
+        out << "{\n  \"simd\": \"" << SimdKernels::levelName(SimdKernels::active().level) << "\",\n";
+        out << "  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"bars\": " << r.bars
+                << ", \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": " << r.seconds * 1e9
+                << ", \"ns_per_bar\": " << r.seconds * 1e9 / r.bars;
+            if (r.combinations > 0) {
+                out << ", \"combinations_per_sec\": " << r.combinations / r.seconds;
+            }
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+};
+
+// Geometric random walk with intrabar noise; the same seed always gives the same series
+static std::shared_ptr<const PriceSeries> randomWalk(std::size_t bars, uint32_t seed = 42) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 1.0);
+    std::vector<int64_t> timestamps(bars);
+    std::vector<double> opens(bars), highs(bars), lows(bars), closes(bars), volumes(bars);
+
+    double price = 100.0;
+    for (std::size_t i = 0; i < bars; ++i) {
+        double open = price;
+        price *= std::exp(0.002 * step(rng));
+        double wick = 0.001 * std::abs(step(rng));
+        timestamps[i] = 1500000000 + static_cast<int64_t>(i) * 60;
+        opens[i] = open;
+        closes[i] = price;
+        highs[i] = std::max(open, price) * (1.0 + wick);
+        lows[i] = std::min(open, price) * (1.0 - wick);
+        volumes[i] = 1000.0 + 100.0 * std::abs(step(rng));
+    }
+    return PriceSeries::fromColumns(timestamps, opens, highs, lows, closes, volumes);
+}
+
+// Run every kernel of `table` and of the scalar table on the same inputs and compare the bits.
+// The inputs include the special cases the kernels branch on (zero volatility, empty or
+// negative stochastic range, negative band variance) and lengths that leave a tail.
+static bool checkSimdAgreement(const SimdKernelTable& table) {
+    const SimdKernelTable& scalar = *SimdKernels::table(SimdLevel::Scalar);
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    bool agree = true;
+
+    for (std::size_t n : {std::size_t(1), std::size_t(7), std::size_t(64), std::size_t(1003)}) {
+        std::vector<double> a(n), b(n), c(n), d(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            a[i] = 100.0 + uniform(rng);
+            b[i] = i % 5 == 0 ? a[i] : a[i] - std::abs(uniform(rng));
+            c[i] = i % 7 == 0 ? 0.0 : uniform(rng);
+            d[i] = i % 11 == 0 ? -1e-12 : std::abs(uniform(rng));
+        }
+
+        auto compare = [&](const char* kernel, const std::vector<double>& x, const std::vector<double>& y) {
+            if (std::memcmp(x.data(), y.data(), x.size() * sizeof(double)) != 0) {
+                std::cerr << SimdKernels::levelName(table.level) << " " << kernel << " differs from scalar at n="
+                          << n << std::endl;
+                agree = false;
+            }
+        };
+        std::vector<double> expected(n, 0.0), actual(n, 0.0), expected2(n, 0.0), actual2(n, 0.0);
+        for (std::size_t period : {std::size_t(1), std::size_t(3)}) {
+            scalar.absChange(a.data(), period, period, n, expected.data());
+            table.absChange(a.data(), period, period, n, actual.data());
+            compare("absChange", expected, actual);
+        }
+        scalar.trueRange(a.data(), b.data(), c.data(), 1, n, expected.data());
+        table.trueRange(a.data(), b.data(), c.data(), 1, n, actual.data());
+        compare("trueRange", expected, actual);
+        scalar.efficiencyRatio(a.data(), c.data(), 0, n, expected.data());
+        table.efficiencyRatio(a.data(), c.data(), 0, n, actual.data());
+        compare("efficiencyRatio", expected, actual);
+        scalar.stochasticK(c.data(), a.data(), b.data(), 0, n, expected.data());
+        table.stochasticK(c.data(), a.data(), b.data(), 0, n, actual.data());
+        compare("stochasticK", expected, actual);
+        scalar.bollingerBands(a.data(), c.data(), c.data(), d.data(), 20.0, 2.0, 0, n, expected.data(), expected2.data());
+        table.bollingerBands(a.data(), c.data(), c.data(), d.data(), 20.0, 2.0, 0, n, actual.data(), actual2.data());
+        compare("bollingerBands", expected, actual);
+        compare("bollingerBands", expected2, actual2);
+    }
+    return agree;
+}
+
+// Distance in units in the last place between two finite doubles
+static uint64_t ulpDistance(double a, double b) {
+    int64_t x, y;
+    std::memcpy(&x, &a, sizeof(x));
+    std::memcpy(&y, &b, sizeof(y));
+    x = x < 0 ? INT64_MIN - x : x;
+    y = y < 0 ? INT64_MIN - y : y;
+    return x > y ? static_cast<uint64_t>(x) - static_cast<uint64_t>(y) : static_cast<uint64_t>(y) - static_cast<uint64_t>(x);
+}
+
+// getBollingerBands keeps running sums instead of summing each window, so it is not bit-exact
+// with the per-window deviation; check it against that O(L) reference within a ULP bound, at
+// a low and a high price level and for short and long windows
+static bool checkBollingerReference(const PriceSeries& prices) {
+    bool agree = true;
+    for (double scale : {1.0, 300.0}) {
+        std::vector<double> closes(prices.size());
+        for (std::size_t i = 0; i < closes.size(); ++i) {
+            closes[i] = prices.closes()[i] * scale;
+        }
+        for (int length : {2, 20, 200}) {
+            for (double multiplier : {1.0, 2.0}) {
+                IndicatorCache cache;
+                SeriesView data(closes);
+                CachedSeries basis = cache.getVAR(data, length);
+                BollingerBands bands = cache.getBollingerBands(data, length, multiplier);
+                uint64_t worst = 0;
+                for (std::size_t i = length; i < closes.size(); ++i) {
+                    double sum_sq = 0.0;
+                    for (std::size_t j = i - length + 1; j <= i; ++j) {
+                        sum_sq += (closes[j] - basis[i]) * (closes[j] - basis[i]);
+                    }
+                    double stdev = std::sqrt(sum_sq / length);
+                    worst = std::max(worst, ulpDistance(bands.upper[i], basis[i] + multiplier * stdev));
+                    worst = std::max(worst, ulpDistance(bands.lower[i], basis[i] - multiplier * stdev));
+                }
+                if (worst > BOLLINGER_MAX_ULPS) {
+                    std::cerr << "getBollingerBands is " << worst << " ulps from the per-window reference (length="
+                              << length << ", multiplier=" << multiplier << ", scale=" << scale << ")" << std::endl;
+                    agree = false;
+                }
+            }
+        }
+    }
+    return agree;
+}
+
+static std::string withSize(const std::string& name, std::size_t bars) {
+    return name + "/" + std::to_string(bars);
+}
+
+static void benchIndicators(BenchRunner& runner, const PriceSeries& prices) {
+    const std::size_t n = prices.size();
+    SeriesView closes = prices.closes();
+    SeriesView highs = prices.highs();
+    SeriesView lows = prices.lows();
+
+    // Every iteration computes into a fresh cache; a warm cache would only measure the lookup
+    auto compute = [&](const std::string& name, const std::function<void(IndicatorCache&)>& body) {
+        runner.run(withSize("IndicatorCache/" + name, n), n, 0.0, [&]() {
+            IndicatorCache cache;
+            body(cache);
+        });
+    };
+
+    IndicatorCache inputs;
+    CachedSeries var = inputs.getVAR(closes, 30);
+    const std::vector<double> multipliers = {0.5, 0.7, 0.9, 1.1, 1.3, 1.5, 1.7, 1.9};
+    const std::vector<int> lengths = {10, 20, 30, 40, 50, 60, 75, 90};
+
+    compute("getStochastic", [&](IndicatorCache& cache) { cache.getStochastic(closes, highs, lows, 14); });
+    compute("getRSI", [&](IndicatorCache& cache) { cache.getRSI(closes, 14); });
+    compute("getVAR", [&](IndicatorCache& cache) { cache.getVAR(closes, 30); });
+    compute("getVARBatch8", [&](IndicatorCache& cache) { cache.getVARBatch(closes, lengths); });
+    compute("getOTT", [&](IndicatorCache& cache) { cache.getOTT(var, 1.0); });
+    compute("getOTTBatch8", [&](IndicatorCache& cache) { cache.getOTTBatch(var, multipliers); });
+    compute("getAbsChange", [&](IndicatorCache& cache) { cache.getAbsChange(closes, 9); });
+    compute("getSumAbsChanges", [&](IndicatorCache& cache) { cache.getSumAbsChanges(closes, 9); });
+    compute("getHighest", [&](IndicatorCache& cache) { cache.getHighest(highs, 20); });
+    compute("getLowest", [&](IndicatorCache& cache) { cache.getLowest(lows, 20); });
+    compute("getATR", [&](IndicatorCache& cache) { cache.getATR(highs, lows, closes, 14); });
+    compute("getBollingerBands", [&](IndicatorCache& cache) { cache.getBollingerBands(closes, 20, 2.0); });
+
+    // Lookups of a series that is already resident, batched so the clock reads do not dominate;
+    // each lookup counts as one bar so ns_per_bar is per lookup
+    const std::size_t lookups = 256;
+    runner.run(withSize("IndicatorCache/hit", n), lookups, 0.0, [&]() {
+        for (std::size_t i = 0; i < lookups; ++i) {
+            inputs.getVAR(closes, 30);
+        }
+    });
+
+    // A miss served from the disk store: mapping and checksumming the file instead of computing
+    const std::string store_name = withSize("IndicatorCache/storeLoad", n);
+    if (runner.selected(store_name)) {
+        const std::string store_dir = "bench_store_" + std::to_string(n);
+        std::shared_ptr<IndicatorStore> store = IndicatorStore::open(store_dir);
+        if (store) {
+            IndicatorCache writer;
+            writer.setStore(store);
+            writer.getVAR(closes, 30);
+            runner.run(store_name, n, 0.0, [&]() {
+                IndicatorCache cache;
+                cache.setStore(store);
+                cache.getVAR(closes, 30);
+            });
+        }
+        std::error_code ec;
+        std::filesystem::remove_all(store_dir, ec);
+    }
+}
+
+static std::vector<int> ottDirections(SeriesView basis, SeriesView ott) {
+    std::vector<int> dir(basis.size());
+    for (std::size_t i = 0; i < basis.size(); ++i) {
+        dir[i] = basis[i] > ott[i] ? 1 : (basis[i] < ott[i] ? -1 : 0);
+    }
+    return dir;
+}
+
+// Trade an OTT direction vector through TradeSimulator::run and through the bar-by-bar
+// StrategyBacktester::runSignals for every SL/TP/pyramiding combination and compare the trade
+// lists and metrics exactly
+static bool checkSimulatorAgreement(std::shared_ptr<const PriceSeries> prices) {
+    auto cache = std::make_shared<IndicatorCache>();
+    CachedSeries var = cache->getVAR(prices->closes(), 20);
+    CachedSeries ott = cache->getOTT(var, 0.5);
+    const std::vector<int> dir = ottDirections(var, ott);
+    const std::vector<double> sl_percents = {0.3, 1.0};
+    const std::vector<double> tp_percents = {0.2, 0.8};
+
+    OttParams params;
+    OttBacktester reference(prices, params, cache);
+    TradeSimulator simulator(*prices);
+    bool agree = true;
+    for (int variant = 0; variant < 8; ++variant) {
+        bool use_sl = (variant & 1) != 0;
+        bool use_tp = (variant & 2) != 0;
+        bool pyramiding = (variant & 4) != 0;
+        std::vector<BacktestResult> results = simulator.run(dir, sl_percents, tp_percents, use_sl, use_tp, pyramiding);
+        for (std::size_t lane = 0; lane < results.size(); ++lane) {
+            double sl = sl_percents[lane / tp_percents.size()];
+            double tp = tp_percents[lane % tp_percents.size()];
+            BacktestResult expected = reference.runSignals(dir, use_sl, use_tp, sl, tp, pyramiding);
+            const BacktestResult& actual = results[lane];
+            bool same = expected.trades.size() == actual.trades.size() &&
+                        expected.net_profit == actual.net_profit && expected.win_rate == actual.win_rate &&
+                        expected.max_drawdown == actual.max_drawdown && expected.sl_trades == actual.sl_trades;
+            for (std::size_t t = 0; same && t < expected.trades.size(); ++t) {
+                const Trade& a = expected.trades[t];
+                const Trade& b = actual.trades[t];
+                same = a.entry_index == b.entry_index && a.exit_index == b.exit_index &&
+                       a.exit_price == b.exit_price && a.profit == b.profit && a.exit_reason == b.exit_reason;
+            }
+            if (!same) {
+                std::cerr << "TradeSimulator differs from the reference backtest for sl=" << sl << " tp=" << tp
+                          << (use_sl ? "" : " nosl") << (use_tp ? "" : " notp") << (pyramiding ? " pyr" : "")
+                          << ": " << actual.trades.size() << " trades, net " << actual.net_profit << " vs "
+                          << expected.trades.size() << " trades, net " << expected.net_profit << std::endl;
+                agree = false;
+            }
+        }
+    }
+    return agree;
+}
+
+static void benchSimulation(BenchRunner& runner, std::shared_ptr<const PriceSeries> price_series) {
+    const PriceSeries& prices = *price_series;
+    const std::size_t n = prices.size();
+    IndicatorCache cache;
+    CachedSeries var = cache.getVAR(prices.closes(), 30);
+    CachedSeries ott = cache.getOTT(var, 1.0);
+    const std::vector<int> dir = ottDirections(var, ott);
+
+    std::vector<double> sl_percents, tp_percents;
+    for (int i = 1; i <= 6; ++i) {
+        sl_percents.push_back(0.5 * i);
+    }
+    for (int i = 4; i <= 10; ++i) {
+        tp_percents.push_back(0.1 * i);
+    }
+    const double lanes = static_cast<double>(sl_percents.size() * tp_percents.size());
+
+    TradeSimulator simulator(prices);
+    std::vector<BacktestMetrics> metrics;
+    for (int variant = 0; variant < 8; ++variant) {
+        bool use_sl = (variant & 1) != 0;
+        bool use_tp = (variant & 2) != 0;
+        bool pyramiding = (variant & 4) != 0;
+        std::string name = std::string("TradeSimulator/runMetrics/") + (use_sl ? "sl" : "nosl") +
+                           (use_tp ? "_tp" : "_notp") + (pyramiding ? "_pyr" : "");
+        runner.run(withSize(name, n), n, lanes, [&]() {
+            simulator.runMetrics(dir, sl_percents, tp_percents, use_sl, use_tp, pyramiding, metrics);
+        });
+    }
+
+    // The generic bar-by-bar path with runtime switches, one lane per call; compare its
+    // combinations/sec with the specialized simulator kernels above
+    OttParams params;
+    OttBacktester reference(price_series, params, std::shared_ptr<IndicatorCache>());
+    for (int variant = 0; variant < 8; ++variant) {
+        bool use_sl = (variant & 1) != 0;
+        bool use_tp = (variant & 2) != 0;
+        bool pyramiding = (variant & 4) != 0;
+        std::string name = std::string("StrategyBacktester/runSignals/") + (use_sl ? "sl" : "nosl") +
+                           (use_tp ? "_tp" : "_notp") + (pyramiding ? "_pyr" : "");
+        runner.run(withSize(name, n), n, 1.0, [&]() {
+            reference.runSignals(dir, use_sl, use_tp, 1.0, 0.5, pyramiding);
+        });
+    }
+
+    runner.run(withSize("TradeSimulator/run", n), n, lanes, [&]() {
+        simulator.run(dir, sl_percents, tp_percents, true, true, false);
+    });
+    runner.run(withSize("TradeSimulator/replay", n), n, 1.0, [&]() {
+        simulator.replay(dir, 1.0, 0.5, true, true, false);
+    });
+
+    // Metrics of a finished trade list, the calculateResults step
+    BacktestResult replayed = simulator.replay(dir, 1.0, 0.5, true, true, false);
+    runner.run(withSize("MetricsAccumulator/trades", n), n, 1.0, [&]() {
+        MetricsAccumulator accumulator(10000.0);
+        for (const auto& trade : replayed.trades) {
+            accumulator.addTrade(trade.profit, trade.exit_reason == "SL");
+        }
+        volatile double net = accumulator.metrics(false).net_profit;
+        (void)net;
+    });
+}
+
+// The whole OTT optimizer grid: plan and precompute the indicators, then simulate every
+// (support length, multiplier) pair across the SL x TP grid on the shared pool
+static void benchOttGrid(BenchRunner& runner, const PriceSeries& prices) {
+    const std::size_t n = prices.size();
+    const std::vector<int> lengths = {10, 20, 30, 40, 50};
+    const std::vector<double> multipliers = {0.5, 0.7, 0.9, 1.1, 1.3, 1.5};
+    std::vector<double> sl_percents, tp_percents;
+    for (int i = 1; i <= 6; ++i) {
+        sl_percents.push_back(0.5 * i);
+    }
+    for (int i = 4; i <= 10; ++i) {
+        tp_percents.push_back(0.1 * i);
+    }
+    const double combinations = static_cast<double>(lengths.size() * multipliers.size() *
+                                                    sl_percents.size() * tp_percents.size());
+
+    TradeSimulator simulator(prices);
+    BacktestFilter filter;
+    filter.min_trades = 30;
+    filter.min_win_rate = 55.0;
+
+    auto precompute = [&](IndicatorCache& cache, const PriceSeries& series) {
+        IndicatorPlan plan;
+        IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+        for (int length : lengths) {
+            IndicatorPlan::Node basis = plan.var(close, length);
+            for (double multiplier : multipliers) {
+                plan.ott(basis, multiplier);
+            }
+        }
+        plan.execute(cache, series);
+    };
+
+    runner.run(withSize("OttGrid/optimize", n), n, combinations, [&]() {
+        IndicatorCache cache;
+        precompute(cache, prices);
+
+        parallelFor(lengths.size() * multipliers.size(), 1, [&](std::size_t begin, std::size_t end) {
+            std::vector<BacktestMetrics> metrics;
+            for (std::size_t c = begin; c < end; ++c) {
+                CachedSeries var = cache.getVAR(prices.closes(), lengths[c / multipliers.size()]);
+                CachedSeries ott = cache.getOTT(var, multipliers[c % multipliers.size()]);
+                simulator.runMetrics(ottDirections(var, ott), sl_percents, tp_percents, true, true, false,
+                                     metrics, filter);
+            }
+        });
+    });
+
+    // The same grid walked forward: in-sample windows four times the out-of-sample length,
+    // stepped by the out-of-sample length, for 56 windows over the series
+    WalkForwardConfig config;
+    config.out_of_sample_bars = std::max<std::size_t>(1, n / 60);
+    config.in_sample_bars = 4 * config.out_of_sample_bars;
+    config.filter = filter;
+    WalkForwardEngine engine(simulator, sl_percents, tp_percents, true, true, false);
+    const double windows = static_cast<double>(WalkForwardEngine::layout(n, config).size());
+
+    runner.run(withSize("OttGrid/walkForward", n), n, combinations * windows, [&]() {
+        IndicatorCache cache;
+        precompute(cache, prices);
+
+        engine.run(n, config, lengths.size() * multipliers.size(),
+                   [&](std::size_t variant) {
+                       return ParamKey(StrategyId::OTT, 0, {static_cast<uint16_t>(variant / multipliers.size()),
+                                                            static_cast<uint16_t>(variant % multipliers.size())});
+                   },
+                   [&](std::size_t variant, std::vector<int>& dir) {
+                       CachedSeries var = cache.getVAR(prices.closes(), lengths[variant / multipliers.size()]);
+                       CachedSeries ott = cache.getOTT(var, multipliers[variant % multipliers.size()]);
+                       dir = ottDirections(var, ott);
+                       return true;
+                   });
+    });
+
+    // The grid continued over the last 5000 bars from the state of a run that stopped before
+    // them, as a nightly re-run after new bars were appended does
+    const std::size_t appended = std::min<std::size_t>(5000, n / 2);
+    auto variantKey = [&](std::size_t variant) {
+        return ParamKey(StrategyId::OTT, 0, {static_cast<uint16_t>(variant / multipliers.size()),
+                                             static_cast<uint16_t>(variant % multipliers.size())});
+    };
+    auto continueGrid = [&](const std::shared_ptr<const PriceSeries>& series, RunState& state) {
+        const std::size_t first_bar = static_cast<std::size_t>(state.capture_bar);
+        const std::size_t capture_bar = series->size() > RunState::OVERLAP_BARS ? series->size() - RunState::OVERLAP_BARS : 0;
+        std::shared_ptr<const PriceSeries> window = RunState::window(series, first_bar);
+        auto tails = std::make_shared<IndicatorTails>(first_bar, capture_bar - first_bar, std::move(state.tails));
+        tails->addColumns(*window);
+        IndicatorCache cache;
+        cache.setTails(tails);
+        precompute(cache, *window);
+
+        TradeSimulator window_simulator(*window);
+        IncrementalRunEngine incremental(window_simulator, sl_percents, tp_percents, true, true, false);
+        std::vector<BacktestResult> results;
+        incremental.run(state.lanes, first_bar, variantKey,
+                        [&](std::size_t variant, std::vector<int>& dir) {
+                            CachedSeries var = cache.getVAR(window->closes(), lengths[variant / multipliers.size()]);
+                            CachedSeries ott = cache.getOTT(var, multipliers[variant % multipliers.size()]);
+                            dir = ottDirections(var, ott);
+                            return true;
+                        },
+                        filter, results);
+        state.bars = series->size();
+        state.capture_bar = capture_bar;
+        state.tails = tails->capturedTails();
+    };
+    if (runner.selected(withSize("OttGrid/incremental", n))) {
+        const PriceSeries& full = prices;
+        std::shared_ptr<const PriceSeries> series = PriceSeries::fromMapped(
+            nullptr, full.timestamps(), full.opens().data(), full.highs().data(), full.lows().data(),
+            full.closes().data(), full.volumes().data(), n, full.checksum());
+        std::shared_ptr<const PriceSeries> before = PriceSeries::fromMapped(
+            nullptr, full.timestamps(), full.opens().data(), full.highs().data(), full.lows().data(),
+            full.closes().data(), full.volumes().data(), n - appended, full.checksum());
+        RunState saved;
+        const LaneState fresh = {MetricsAccumulator(10000.0), std::vector<OpenPosition>(), 0};
+        saved.lanes.assign(lengths.size() * multipliers.size(),
+                           std::vector<LaneState>(sl_percents.size() * tp_percents.size(), fresh));
+        continueGrid(before, saved);
+
+        runner.run(withSize("OttGrid/incremental", n), appended, combinations, [&]() {
+            RunState state = saved;
+            continueGrid(series, state);
+        });
+    }
+}
+
+// Sends std::cout to a sink while alive, so optimizer progress lines stay out of the report
+class QuietStdout {
+private:
+    std::ostringstream sink;
+    std::streambuf* saved;
+
+public:
+    QuietStdout() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~QuietStdout() { std::cout.rdbuf(saved); }
+
+    // Everything printed so far
+    std::string text() const { return sink.str(); }
+};
+
+// The OTT optimizer on the shared pool and split over two emulated NUMA shards (heap replicas
+// on unpinned pools), so the sharded path runs on any machine. Both must find the same results.
+static bool benchNumaSplit(BenchRunner& runner, std::shared_ptr<const PriceSeries> prices) {
+    const std::size_t n = prices->size();
+    const std::string shared_name = withSize("OttOptimizer/shared", n);
+    const std::string split_name = withSize("OttOptimizer/numa2", n);
+    if (!runner.selected(shared_name) && !runner.selected(split_name)) {
+        return true;
+    }
+    std::shared_ptr<NumaShards> shards = NumaShards::create(*prices, ThreadPool::shared().size(), 0, 2);
+    OttOptimizer shared(prices);
+    OttOptimizer split(prices);
+    split.setNumaShards(shards);
+    const double combinations = static_cast<double>(shared.signalVariants() * 3 * 3);  // Default 3 x 3 SL/TP grid
+
+    std::vector<BacktestResult> expected, actual;
+    {
+        QuietStdout quiet;
+        expected = shared.optimize();
+        actual = split.optimize();
+    }
+    bool same = expected.size() == actual.size();
+    for (std::size_t i = 0; same && i < expected.size(); ++i) {
+        same = expected[i].param_key == actual[i].param_key && expected[i].net_profit == actual[i].net_profit &&
+               expected[i].total_trades == actual[i].total_trades;
+    }
+    if (!same) {
+        std::cerr << "OttOptimizer on two emulated NUMA shards differs from the shared pool: " << actual.size()
+                  << " vs " << expected.size() << " results" << std::endl;
+        return false;
+    }
+
+    runner.run(shared_name, n, combinations, [&]() {
+        QuietStdout quiet;
+        shared.setIndicatorCache(std::make_shared<IndicatorCache>());
+        shared.optimize();
+    });
+    runner.run(split_name, n, combinations, [&]() {
+        QuietStdout quiet;
+        for (std::size_t s = 0; s < shards->size(); ++s) {
+            shards->shard(s).cache->clear();
+        }
+        split.optimize();
+    });
+    return true;
+}
+
+// Every strategy run incrementally (a first run over all but the last bars, then a run that
+// continues its saved state over the full series) must find exactly the results of a full run,
+// and the second run must really continue rather than fall back to bar 0
+static bool checkIncrementalAgreement(std::shared_ptr<const PriceSeries> prices, std::size_t appended) {
+    const std::size_t before_bars = prices->size() - appended;
+    std::shared_ptr<const PriceSeries> before = PriceSeries::fromMapped(
+        prices, prices->timestamps(), prices->opens().data(), prices->highs().data(), prices->lows().data(),
+        prices->closes().data(), prices->volumes().data(), before_bars, 0);
+
+    // Any lane with a trade passes, so every strategy has results to compare
+    auto create = [](StrategyId id, std::shared_ptr<const PriceSeries> series) {
+        std::unique_ptr<StrategyOptimizer> optimizer = createOptimizer(id, std::move(series));
+        optimizer->setTradeSettings({1.0, 2.0, 3.0}, {2.0, 3.0, 5.0}, true, true, false, 10000.0, 1, 0.0, false);
+        return optimizer;
+    };
+
+    bool agree = true;
+    for (int s = 0; s <= static_cast<int>(StrategyId::BOOTS); ++s) {
+        const StrategyId id = static_cast<StrategyId>(s);
+        const std::string state_path = std::string("bench_state_") + ParamGrid::strategyName(id) + ".run";
+        std::vector<BacktestResult> expected, actual;
+        bool continued;
+        {
+            QuietStdout quiet;
+            expected = create(id, prices)->optimize();
+            std::remove(state_path.c_str());
+            create(id, before)->optimizeIncremental(state_path);
+            actual = create(id, prices)->optimizeIncremental(state_path);
+            std::remove(state_path.c_str());
+            continued = quiet.text().find("incremental run from bar " + std::to_string(before_bars) + " ") != std::string::npos;
+        }
+        if (!continued) {
+            std::cerr << "Incremental " << ParamGrid::strategyName(id) << " run did not continue from bar "
+                      << before_bars << std::endl;
+            agree = false;
+        }
+
+        bool same = expected.size() == actual.size();
+        for (std::size_t i = 0; same && i < expected.size(); ++i) {
+            const BacktestResult& a = expected[i];
+            const BacktestResult& b = actual[i];
+            same = a.param_key == b.param_key && a.net_profit == b.net_profit && a.total_trades == b.total_trades &&
+                   a.win_rate == b.win_rate && a.max_drawdown == b.max_drawdown && a.sl_trades == b.sl_trades;
+        }
+        if (!same) {
+            std::cerr << "Incremental " << ParamGrid::strategyName(id) << " run differs from a full run: "
+                      << actual.size() << " vs " << expected.size() << " results" << std::endl;
+            agree = false;
+        }
+    }
+    return agree;
+}
+
+static void benchCsv(BenchRunner& runner, const PriceSeries& prices) {
+    const std::size_t n = prices.size();
+    const std::string name = withSize("PriceSeries/loadCSVColumns", n);
+    if (!runner.selected(name)) {
+        return;
+    }
+
+    const std::string path = "bench_" + std::to_string(n) + ".csv";
+    {
+        std::ofstream out(path);
+        out << "Date,Open,High,Low,Close,Volume\n";
+        char line[160];
+        for (std::size_t i = 0; i < n; ++i) {
+            std::snprintf(line, sizeof(line), "%lld,%.6f,%.6f,%.6f,%.6f,%.2f\n",
+                          static_cast<long long>(prices.timestamp(i)), prices.opens()[i], prices.highs()[i],
+                          prices.lows()[i], prices.closes()[i], prices.volumes()[i]);
+            out << line;
+        }
+    }
+
+    // The loader reports its parse rate on stdout, which would corrupt the JSON report
+    std::ostringstream discard;
+    std::streambuf* stdout_buffer = std::cout.rdbuf(discard.rdbuf());
+    std::vector<int64_t> timestamps;
+    std::vector<double> opens, highs, lows, closes, volumes;
+    bool has_time_of_day;
+    runner.run(name, n, 0.0, [&]() {
+        PriceSeries::loadCSVColumns(path, timestamps, opens, highs, lows, closes, volumes, has_time_of_day);
+        discard.str(std::string());
+    });
+    std::cout.rdbuf(stdout_buffer);
+    std::remove(path.c_str());
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes = {10000, 1000000, 10000000};
+    std::string filter;
+    double min_time = 0.2;
+    std::size_t csv_max_bars = 1000000;
+    std::string out_path;
+    bool check_only = false;
+    SimdLevel simd_level = SimdKernels::detect();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.find("--sizes=") == 0) {
+            sizes.clear();
+            std::stringstream ss(arg.substr(8));
+            std::string size;
+            while (std::getline(ss, size, ',')) {
+                sizes.push_back(std::stoul(size));
+            }
+        } else if (arg.find("--filter=") == 0) {
+            filter = arg.substr(9);
+        } else if (arg.find("--min-time=") == 0) {
+            min_time = std::stod(arg.substr(11));
+        } else if (arg.find("--csv-max-bars=") == 0) {
+            csv_max_bars = std::stoul(arg.substr(15));
+        } else if (arg == "--check") {
+            check_only = true;
+        } else if (arg.find("--out=") == 0) {
+            out_path = arg.substr(6);
+        } else if (arg.find("--simd=") == 0) {
+            if (!SimdKernels::levelFromName(arg.c_str() + 7, simd_level)) {
+                std::cerr << "Unknown SIMD level: " << arg.substr(7) << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::AVX512}) {
+        const SimdKernelTable* table = SimdKernels::table(level);
+        if (table != nullptr && !checkSimdAgreement(*table)) {
+            return 1;
+        }
+    }
+    if (!checkBollingerReference(*randomWalk(20000, 5))) {
+        return 1;
+    }
+    if (!checkSimulatorAgreement(randomWalk(20000, 3))) {
+        return 1;
+    }
+    if (!checkIncrementalAgreement(randomWalk(5000, 7), 700)) {
+        return 1;
+    }
+    if (check_only) {
+        std::cerr << "All checks passed" << std::endl;
+        return 0;
+    }
+    if (!SimdKernels::setLevel(simd_level)) {
+        std::cerr << "SIMD level " << SimdKernels::levelName(simd_level) << " is not available here" << std::endl;
+        return 1;
+    }
+
+    BenchRunner runner(filter, min_time);
+    for (std::size_t bars : sizes) {
+        auto prices = randomWalk(bars);
+        benchIndicators(runner, *prices);
+        benchSimulation(runner, prices);
+        benchOttGrid(runner, *prices);
+        if (!benchNumaSplit(runner, prices)) {
+            return 1;
+        }
+        // Writing the CSV is slow and large at 10M bars, so parsing is only timed up to a cap
+        if (bars <= csv_max_bars) {
+            benchCsv(runner, *prices);
+        }
+    }
+
+    if (out_path.empty()) {
+        runner.writeJson(std::cout);
+    } else {
+        std::ofstream out(out_path);
+        runner.writeJson(out);
+    }
+    return 0;
+}
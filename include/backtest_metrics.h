@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include "models.h"
+
+// Plain summary of one backtest; the fields of BacktestResult without the trade list or
+// strings, so grids of them can be kept and filtered without any heap allocation
+struct BacktestMetrics {
+    double net_profit;
+    double profit_factor;
+    int total_trades;
+    int winning_trades;
+    int losing_trades;
+    double win_rate;
+    double max_drawdown;
+    double profit_percent;
+    int sl_trades;
+    double sl_win_rate;
+    bool pruned;           // Simulation stopped early because the filter could no longer pass
+
+    // Copy the metrics into a full result (trades, params_str and strategy_name untouched)
+    void applyTo(BacktestResult& result) const {
+        result.net_profit = net_profit;
+        result.profit_factor = profit_factor;
+        result.total_trades = total_trades;
+        result.winning_trades = winning_trades;
+        result.losing_trades = losing_trades;
+        result.win_rate = win_rate;
+        result.max_drawdown = max_drawdown;
+        result.profit_percent = profit_percent;
+        result.sl_trades = sl_trades;
+        result.sl_win_rate = sl_win_rate;
+    }
+};
+
+// The optimizer's result filter: enough trades and a high enough win rate
+struct BacktestFilter {
+    int min_trades = 0;
+    double min_win_rate = 0.0;
+
+    bool passes(const BacktestMetrics& metrics) const {
+        return !metrics.pruned && metrics.total_trades >= min_trades && metrics.win_rate >= min_win_rate;
+    }
+};
+
+// Streaming backtest metrics, fed one closed trade at a time in exit order. Drawdown is
+// measured on the closed-trade equity curve relative to its running peak.
+class MetricsAccumulator {
+private:
+    double initial_capital;
+    double net_profit;
+    double gross_profit;
+    double gross_loss;
+    double equity_peak;
+    double max_drawdown;
+    int total_trades;
+    int winning_trades;
+    int sl_trades;
+    bool was_pruned;
+
+public:
+    explicit MetricsAccumulator(double capital = 10000.0) { reset(capital); }
+
+    void reset(double capital) {
+        initial_capital = capital;
+        net_profit = 0.0;
+        gross_profit = 0.0;
+        gross_loss = 0.0;
+        equity_peak = capital;
+        max_drawdown = 0.0;
+        total_trades = 0;
+        winning_trades = 0;
+        sl_trades = 0;
+        was_pruned = false;
+    }
+
+    void addTrade(double profit, bool stop_loss) {
+        total_trades++;
+        if (profit > 0) {
+            winning_trades++;
+            gross_profit += profit;
+        } else {
+            gross_loss -= profit;
+        }
+        if (stop_loss) {
+            sl_trades++;
+        }
+
+        net_profit += profit;
+        double equity = initial_capital + net_profit;
+        equity_peak = std::max(equity_peak, equity);
+        if (equity_peak > 0) {
+            max_drawdown = std::max(max_drawdown, (equity_peak - equity) / equity_peak * 100.0);
+        }
+    }
+
+    int trades() const { return total_trades; }
+    int wins() const { return winning_trades; }
+    int stopLosses() const { return sl_trades; }
+    bool pruned() const { return was_pruned; }
+    void prune() { was_pruned = true; }
+
+    // Whether the filter can still pass if at most `future_trades` more trades close. The
+    // best case is that every one of them is a winning non-SL trade; the win rate then only
+    // grows with their number, so checking the maximum bounds both filters at once.
+    bool canStillPass(const BacktestFilter& filter, int future_trades, bool exclude_sl_from_winrate) const {
+        int best_trades = total_trades + future_trades;
+        if (best_trades < filter.min_trades) {
+            return false;
+        }
+        int counted = (exclude_sl_from_winrate ? total_trades - sl_trades : total_trades) + future_trades;
+        double best_win_rate = counted > 0 ? 100.0 * (winning_trades + future_trades) / counted : 0.0;
+        return best_win_rate >= filter.min_win_rate;
+    }
+
+    BacktestMetrics metrics(bool exclude_sl_from_winrate) const {
+        BacktestMetrics result;
+        result.net_profit = net_profit;
+        result.profit_factor = gross_loss > 0 ? gross_profit / gross_loss
+                             : gross_profit > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+        result.total_trades = total_trades;
+        result.winning_trades = winning_trades;
+        result.losing_trades = total_trades - winning_trades;
+        result.max_drawdown = max_drawdown;
+        result.profit_percent = net_profit / initial_capital * 100.0;
+        result.sl_trades = sl_trades;
+        result.pruned = was_pruned;
+
+        int non_sl_trades = total_trades - sl_trades;
+        result.sl_win_rate = non_sl_trades > 0 ? 100.0 * winning_trades / non_sl_trades : 0.0;
+        result.win_rate = total_trades > 0 ? 100.0 * winning_trades / total_trades : 0.0;
+        if (exclude_sl_from_winrate) {
+            result.win_rate = result.sl_win_rate;
+        }
+        return result;
+    }
+};
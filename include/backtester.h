@@ -6,15 +6,16 @@
 #include <algorithm>
 #include "models.h"
 #include "indicators.h"
+#include "price_series.h"
 
 // Base backtester class
 class StrategyBacktester {
 protected:
-    const std::vector<Bar>& bars;
-    const std::vector<double>& closes;
-    const std::vector<double>& highs;
-    const std::vector<double>& lows;
-    const std::vector<double>& opens;
+    std::shared_ptr<const PriceSeries> prices;
+    SeriesView closes;
+    SeriesView highs;
+    SeriesView lows;
+    SeriesView opens;
     double initial_capital;
     bool exclude_sl_from_winrate;
     std::shared_ptr<IndicatorCache> cache;
@@ -26,22 +27,27 @@ protected:
     // Method to calculate backtest results
     BacktestResult calculateResults(const std::vector<Trade>& trades, const std::string& params_str, const std::string& strategy_name);
     
+    // Trade a direction vector with the SL/TP switches of `params` and label the result
+    BacktestResult backtest(const std::vector<int>& dir, const StrategyParams& params);
+    
 public:
-    StrategyBacktester(const std::vector<Bar>& price_data, 
-                     const std::vector<double>& close_prices,
-                     const std::vector<double>& high_prices,
-                     const std::vector<double>& low_prices,
-                     const std::vector<double>& open_prices,
+    StrategyBacktester(std::shared_ptr<const PriceSeries> price_series,
                      std::shared_ptr<IndicatorCache> indicator_cache,
                      double capital = 10000.0,
                      bool exclude_sl = false);
                   
     virtual ~StrategyBacktester() = default;
     
-    // Static method to load data from CSV
+    // Bar-by-bar backtest of a direction vector under the trade rules documented on
+    // TradeSimulator. Kept as the plain reference the simulator's kernels are checked against.
+    BacktestResult runSignals(const std::vector<int>& dir, bool use_sl, bool use_tp,
+                              double sl_percent, double tp_percent, bool pyramiding);
+    
+    // Deprecated: load through PriceSeries::load and read the columns from the series
+    [[deprecated("use PriceSeries::load")]]
     static std::vector<Bar> loadCSV(const std::string& filename);
     
-    // Static method to preprocess price data vectors
+    [[deprecated("use the PriceSeries column views")]]
     static void preprocessPriceData(const std::vector<Bar>& bars, 
                                   std::vector<double>& closes,
                                   std::vector<double>& highs,
@@ -49,23 +55,28 @@ public:
                                   std::vector<double>& opens);
 };
 
+// Every strategy backtester below turns its parameters into a direction vector (1 long,
+// -1 short, 0 no opinion) through static signals(), which only reads indicator series from
+// the given cache and the columns of the given prices, so optimizers can call it for any
+// combination without building a backtester. A direction only depends on the indicators of
+// the same bar unless the strategy says otherwise.
+
 // Strategy-specific backtester classes
 class OttBacktester : public StrategyBacktester {
 private:
     const OttParams& params;
     
 public:
-    OttBacktester(const std::vector<Bar>& price_data, 
-                const std::vector<double>& close_prices,
-                const std::vector<double>& high_prices,
-                const std::vector<double>& low_prices,
-                const std::vector<double>& open_prices,
+    OttBacktester(std::shared_ptr<const PriceSeries> price_series,
                 const OttParams& strategy_params, 
                 std::shared_ptr<IndicatorCache> indicator_cache,
                 double capital = 10000.0,
                 bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const OttParams& strategy_params, std::vector<int>& dir);
 };
 
 class TottBacktester : public StrategyBacktester {
@@ -73,17 +84,16 @@ private:
     const TottParams& params;
     
 public:
-    TottBacktester(const std::vector<Bar>& price_data, 
-                 const std::vector<double>& close_prices,
-                 const std::vector<double>& high_prices,
-                 const std::vector<double>& low_prices,
-                 const std::vector<double>& open_prices,
+    TottBacktester(std::shared_ptr<const PriceSeries> price_series,
                  const TottParams& strategy_params, 
                  std::shared_ptr<IndicatorCache> indicator_cache,
                  double capital = 10000.0,
                  bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const TottParams& strategy_params, std::vector<int>& dir);
 };
 
 class OttChannelBacktester : public StrategyBacktester {
@@ -91,17 +101,16 @@ private:
     const OttChannelParams& params;
     
 public:
-    OttChannelBacktester(const std::vector<Bar>& price_data, 
-                       const std::vector<double>& close_prices,
-                       const std::vector<double>& high_prices,
-                       const std::vector<double>& low_prices,
-                       const std::vector<double>& open_prices,
+    OttChannelBacktester(std::shared_ptr<const PriceSeries> price_series,
                        const OttChannelParams& strategy_params, 
                        std::shared_ptr<IndicatorCache> indicator_cache,
                        double capital = 10000.0,
                        bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const OttChannelParams& strategy_params, std::vector<int>& dir);
 };
 
 class RisottoBacktester : public StrategyBacktester {
@@ -109,17 +118,16 @@ private:
     const RisottoParams& params;
     
 public:
-    RisottoBacktester(const std::vector<Bar>& price_data, 
-                    const std::vector<double>& close_prices,
-                    const std::vector<double>& high_prices,
-                    const std::vector<double>& low_prices,
-                    const std::vector<double>& open_prices,
+    RisottoBacktester(std::shared_ptr<const PriceSeries> price_series,
                     const RisottoParams& strategy_params, 
                     std::shared_ptr<IndicatorCache> indicator_cache,
                     double capital = 10000.0,
                     bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const RisottoParams& strategy_params, std::vector<int>& dir);
 };
 
 class SottBacktester : public StrategyBacktester {
@@ -127,17 +135,16 @@ private:
     const SottParams& params;
     
 public:
-    SottBacktester(const std::vector<Bar>& price_data, 
-                 const std::vector<double>& close_prices,
-                 const std::vector<double>& high_prices,
-                 const std::vector<double>& low_prices,
-                 const std::vector<double>& open_prices,
+    SottBacktester(std::shared_ptr<const PriceSeries> price_series,
                  const SottParams& strategy_params, 
                  std::shared_ptr<IndicatorCache> indicator_cache,
                  double capital = 10000.0,
                  bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const SottParams& strategy_params, std::vector<int>& dir);
 };
 
 class HottLottBacktester : public StrategyBacktester {
@@ -145,17 +152,17 @@ private:
     const HottLottParams& params;
     
 public:
-    HottLottBacktester(const std::vector<Bar>& price_data, 
-                     const std::vector<double>& close_prices,
-                     const std::vector<double>& high_prices,
-                     const std::vector<double>& low_prices,
-                     const std::vector<double>& open_prices,
+    HottLottBacktester(std::shared_ptr<const PriceSeries> price_series,
                      const HottLottParams& strategy_params, 
                      std::shared_ptr<IndicatorCache> indicator_cache,
                      double capital = 10000.0,
                      bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    // With use_sum, a side needs its condition on each of the last sum_n_bars bars
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const HottLottParams& strategy_params, std::vector<int>& dir);
 };
 
 class RottBacktester : public StrategyBacktester {
@@ -163,17 +170,16 @@ private:
     const RottParams& params;
     
 public:
-    RottBacktester(const std::vector<Bar>& price_data, 
-                 const std::vector<double>& close_prices,
-                 const std::vector<double>& high_prices,
-                 const std::vector<double>& low_prices,
-                 const std::vector<double>& open_prices,
+    RottBacktester(std::shared_ptr<const PriceSeries> price_series,
                  const RottParams& strategy_params, 
                  std::shared_ptr<IndicatorCache> indicator_cache,
                  double capital = 10000.0,
                  bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const RottParams& strategy_params, std::vector<int>& dir);
 };
 
 class FtBacktester : public StrategyBacktester {
@@ -181,17 +187,16 @@ private:
     const FtParams& params;
     
 public:
-    FtBacktester(const std::vector<Bar>& price_data, 
-               const std::vector<double>& close_prices,
-               const std::vector<double>& high_prices,
-               const std::vector<double>& low_prices,
-               const std::vector<double>& open_prices,
+    FtBacktester(std::shared_ptr<const PriceSeries> price_series,
                const FtParams& strategy_params, 
                std::shared_ptr<IndicatorCache> indicator_cache,
                double capital = 10000.0,
                bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const FtParams& strategy_params, std::vector<int>& dir);
 };
 
 class RtrBacktester : public StrategyBacktester {
@@ -199,17 +204,16 @@ private:
     const RtrParams& params;
     
 public:
-    RtrBacktester(const std::vector<Bar>& price_data, 
-                const std::vector<double>& close_prices,
-                const std::vector<double>& high_prices,
-                const std::vector<double>& low_prices,
-                const std::vector<double>& open_prices,
+    RtrBacktester(std::shared_ptr<const PriceSeries> price_series,
                 const RtrParams& strategy_params, 
                 std::shared_ptr<IndicatorCache> indicator_cache,
                 double capital = 10000.0,
                 bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const RtrParams& strategy_params, std::vector<int>& dir);
 };
 
 class MottBacktester : public StrategyBacktester {
@@ -217,17 +221,16 @@ private:
     const MottParams& params;
     
 public:
-    MottBacktester(const std::vector<Bar>& price_data, 
-                 const std::vector<double>& close_prices,
-                 const std::vector<double>& high_prices,
-                 const std::vector<double>& low_prices,
-                 const std::vector<double>& open_prices,
+    MottBacktester(std::shared_ptr<const PriceSeries> price_series,
                  const MottParams& strategy_params, 
                  std::shared_ptr<IndicatorCache> indicator_cache,
                  double capital = 10000.0,
                  bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const MottParams& strategy_params, std::vector<int>& dir);
 };
 
 class BootsBacktester : public StrategyBacktester {
@@ -235,15 +238,17 @@ private:
     const BootsParams& params;
     
 public:
-    BootsBacktester(const std::vector<Bar>& price_data, 
-                  const std::vector<double>& close_prices,
-                  const std::vector<double>& high_prices,
-                  const std::vector<double>& low_prices,
-                  const std::vector<double>& open_prices,
+    // Width of the Bollinger bands in standard deviations
+    static constexpr double BB_MULTIPLIER = 2.0;
+    
+    BootsBacktester(std::shared_ptr<const PriceSeries> price_series,
                   const BootsParams& strategy_params, 
                   std::shared_ptr<IndicatorCache> indicator_cache,
                   double capital = 10000.0,
                   bool exclude_sl = false);
     
     BacktestResult runBacktest();
+    
+    static void signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                        const BootsParams& strategy_params, std::vector<int>& dir);
 };
\ No newline at end of file
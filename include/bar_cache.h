@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "price_series.h"
+
+// On-disk layout of a binary bar cache file. The header is followed by six
+// 64-byte aligned columns: int64 timestamps, then float64 open/high/low/close/volume.
+struct BarCacheHeader {
+    char magic[8];              // "TSOBARS\0"
+    uint32_t version;
+    uint32_t byte_order;        // 0x01020304 in the writer's native order
+    uint64_t bar_count;
+    uint64_t source_size;       // Size of the CSV the cache was built from
+    int64_t source_mtime;       // Modification time of that CSV (file clock ticks)
+    uint64_t source_checksum;   // PriceSeries::columnsChecksum of the columns
+    uint64_t column_offsets[6]; // Byte offsets of timestamp/open/high/low/close/volume
+    uint64_t column_ids[5];     // seriesContentId of open/high/low/close/volume
+    uint64_t flags;             // BAR_CACHE_TIME_OF_DAY if the CSV dates carried a time
+    uint64_t reserved[5];
+};
+
+static const uint64_t BAR_CACHE_TIME_OF_DAY = 1;
+
+// Size and modification time of a CSV, which identify its version without reading it
+struct BarSourceStamp {
+    uint64_t size;
+    int64_t mtime;
+
+    bool operator==(const BarSourceStamp& other) const { return size == other.size && mtime == other.mtime; }
+};
+
+// Binary columnar cache that sits next to a CSV file ("data.csv" -> "data.csv.bars")
+class BarCache {
+public:
+    static const uint32_t FORMAT_VERSION = 3;
+    
+    // Path of the cache file for a given CSV
+    static std::string cachePath(const std::string& csv_filename);
+    
+    // Map the cache as a zero-copy PriceSeries if it exists and still matches the CSV's
+    // size and mtime; returns nullptr otherwise. The CSV is not re-read, so an edit that keeps
+    // both (e.g. a copy with preserved timestamps) goes unnoticed; --no-bar-cache or deleting
+    // the cache file forces a re-parse.
+    static std::shared_ptr<const PriceSeries> map(const std::string& csv_filename);
+    
+    // Stamp of the CSV as it is now; returns false if it cannot be stat'ed
+    static bool stampSource(const std::string& csv_filename, BarSourceStamp& stamp);
+    
+    // Write the cache for a CSV (via a temporary file and atomic rename). `source` must be the
+    // stamp taken before the columns were parsed; if the CSV no longer has it, nothing is
+    // written, so a cache never pairs a newer CSV stamp with older columns.
+    static bool save(const std::string& csv_filename,
+                   const BarSourceStamp& source,
+                   const std::vector<int64_t>& timestamps,
+                   const std::vector<double>& opens,
+                   const std::vector<double>& highs,
+                   const std::vector<double>& lows,
+                   const std::vector<double>& closes,
+                   const std::vector<double>& volumes,
+                   bool has_time_of_day);
+};
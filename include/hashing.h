@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 64-bit finalizer from splitmix64
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Order-dependent combination of two 64-bit hashes
+inline uint64_t hashCombine64(uint64_t seed, uint64_t value) {
+    return mix64(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+// Fast non-cryptographic checksum of a byte range; four independent lanes keep
+// it close to memory bandwidth on multi-GB files
+inline uint64_t hashBytes64(const void* data, std::size_t size, uint64_t seed = 0) {
+    const uint64_t k1 = 0x9e3779b97f4a7c15ULL;
+    const uint64_t k2 = 0xc2b2ae3d27d4eb4fULL;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+
+    uint64_t lanes[4] = {seed ^ k1, seed ^ k2, ~seed, seed + size};
+    std::size_t blocks = size / 32;
+    for (std::size_t b = 0; b < blocks; ++b, p += 32) {
+        for (int j = 0; j < 4; ++j) {
+            uint64_t word;
+            std::memcpy(&word, p + j * 8, sizeof(word));
+            uint64_t x = lanes[j] ^ (word * k2);
+            lanes[j] = ((x << 31) | (x >> 33)) * k1;
+        }
+    }
+
+    uint64_t tail = 0;
+    std::memcpy(&tail, p, size % 32 < 8 ? size % 32 : 8);
+    uint64_t result = mix64(size ^ tail);
+    for (std::size_t offset = 8; offset < size % 32; offset += 8) {
+        uint64_t word = 0;
+        std::memcpy(&word, p + offset, size % 32 - offset < 8 ? size % 32 - offset : 8);
+        result = hashCombine64(result, word);
+    }
+    for (int j = 0; j < 4; ++j) {
+        result = hashCombine64(result, lanes[j]);
+    }
+    return result;
+}
+
+// Content identity of a double series, shared by price columns and indicator inputs
+inline uint64_t seriesContentId(const double* values, std::size_t count) {
+    return hashCombine64(hashBytes64(values, count * sizeof(double)), count);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "backtest_metrics.h"
+#include "indicator_tails.h"
+#include "price_series.h"
+#include "thread_pool.h"
+#include "trade_simulator.h"
+#include "walk_forward.h"
+
+// On-disk layout of a run state file. The header is followed by the lanes (per variant, per
+// lane: MetricsAccumulator, next bar, position count, OpenPositions) and then the tails (per
+// tail: recipe, bar, register count, history count, registers, history).
+struct RunStateHeader {
+    char magic[8];              // "TSORUN\0\0"
+    uint32_t version;
+    uint32_t byte_order;        // 0x01020304 in the writer's native order
+    uint64_t bars;
+    uint64_t capture_bar;
+    uint64_t column_ids[5];     // seriesContentId of open/high/low/close/volume over `bars`
+    uint64_t grid;
+    uint64_t variant_count;
+    uint64_t lanes_per_variant;
+    uint64_t tail_count;
+    uint64_t body_size;
+    uint64_t body_checksum;     // hashBytes64 of everything after the header
+    uint64_t reserved[4];
+};
+
+// Where an optimizer run over the first `bars` bars of a series stopped, so that a run on
+// the same series with bars appended only has to process the new ones. Lanes are held at
+// `bars`; the indicator tails at `capture_bar`, a little earlier, because the new run
+// recomputes the signals of the bars just before `bars` from there (see OVERLAP_BARS).
+struct RunState {
+    static const uint32_t FORMAT_VERSION = 1;
+
+    // Bars before the end of a run that the next one starts its window at. A strategy's
+    // direction at a bar may depend on the indicators of fewer bars before it than this
+    // (see StrategyOptimizer::signalLookback()).
+    static const std::size_t OVERLAP_BARS = 64;
+
+    uint64_t bars = 0;                              // 0 for a run that has not started
+    uint64_t capture_bar = 0;
+    uint64_t column_ids[5] = {};
+    uint64_t grid = 0;                              // Fingerprint of the grid and settings
+    std::vector<std::vector<LaneState>> lanes;      // Per signal variant, in runMetrics order
+    std::unordered_map<uint64_t, IndicatorTail> tails;
+
+    // Write via a temporary file and atomic rename
+    bool save(const std::string& path) const;
+
+    // Read a state file; false if it is missing, or (with a message) unreadable or corrupt
+    static bool load(const std::string& path, RunState& state);
+
+    // Whether `prices` starts with exactly the bars this state covers
+    bool continues(const PriceSeries& prices) const;
+
+    // Bars [first_bar, end) of `prices` as a series of their own, sharing its columns
+    static std::shared_ptr<const PriceSeries> window(const std::shared_ptr<const PriceSeries>& prices,
+                                                     std::size_t first_bar);
+};
+
+// Runs a grid of signal variants times the SL x TP grid on a window of a grown series,
+// continuing every lane from a RunState. The simulator, the indicator cache behind the
+// signals and the signals themselves all work on the window; the engine only tracks where
+// each lane stands.
+class IncrementalRunEngine {
+public:
+    typedef WalkForwardEngine::SignalSource SignalSource;
+    typedef WalkForwardEngine::VariantKey VariantKey;
+
+private:
+    const TradeSimulator& simulator;
+    std::vector<double> sl_percents;
+    std::vector<double> tp_percents;
+    bool use_sl;
+    bool use_tp;
+    bool pyramiding;
+
+public:
+    IncrementalRunEngine(const TradeSimulator& window_simulator,
+                         const std::vector<double>& sl_pcts,
+                         const std::vector<double>& tp_pcts,
+                         bool enable_sl,
+                         bool enable_tp,
+                         bool enable_pyramiding);
+
+    // Fingerprint of the variant keys, the values behind them, the SL/TP grid, the switches
+    // and the indicator output version; a state only continues a run with the same one
+    static uint64_t fingerprint(std::size_t variant_count,
+                                const VariantKey& variant_key,
+                                const ParamGrid& grid,
+                                const std::vector<double>& sl_percents,
+                                const std::vector<double>& tp_percents,
+                                bool use_sl,
+                                bool use_tp,
+                                bool pyramiding);
+
+    // Advance every lane of `lanes` (one list per variant) over the window, which starts at
+    // absolute bar `first_bar`, and append the lanes that pass `filter` to `results` with
+    // their param_key set. Returns false (with a message) if the lanes do not fit.
+    bool run(std::vector<std::vector<LaneState>>& lanes,
+             std::size_t first_bar,
+             const VariantKey& variant_key,
+             const SignalSource& signals,
+             const BacktestFilter& filter,
+             std::vector<BacktestResult>& results,
+             ThreadPool& pool = ThreadPool::shared()) const;
+};
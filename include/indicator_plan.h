@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <vector>
+#include "indicators.h"
+#include "thread_pool.h"
+#include "price_series.h"
+
+// Price columns an indicator plan can start from
+enum class PriceColumn : int {
+    Open,
+    High,
+    Low,
+    Close
+};
+
+// The set of indicators an optimizer grid needs, as a DAG over the price columns. Identical
+// requests collapse into one node, so the plan holds each unique series once (e.g. one VAR per
+// length however many OTT multipliers use it). Executing the plan computes every node through
+// the IndicatorCache in dependency order, so the backtests that follow only see cache hits.
+class IndicatorPlan {
+public:
+    typedef int Node;
+
+private:
+    struct Step {
+        bool is_column;
+        PriceColumn column;
+        IndicatorKind kind;
+        Node inputs[3];
+        int length;
+        double multiplier;
+        int level;          // 0 for price columns, else 1 + the deepest input
+    };
+
+    std::vector<Step> steps;
+    std::map<std::tuple<int, int, int, int, int, double>, Node> step_index;
+
+    Node addStep(IndicatorKind kind, Node a, Node b, Node c, int length, double multiplier);
+
+public:
+    // Source nodes for the price columns
+    Node column(PriceColumn column);
+
+    // Indicator nodes, mirroring the IndicatorCache getters
+    Node stochastic(Node closes, Node highs, Node lows, int k_length);
+    Node rsi(Node closes, int length);
+    Node var(Node data, int length);
+    Node ott(Node data, double multiplier);
+    Node highest(Node data, int period);
+    Node lowest(Node data, int period);
+    Node atr(Node highs, Node lows, Node closes, int period);
+    Node bollingerBands(Node data, int length, double multiplier);
+
+    // Number of indicator nodes (price columns excluded)
+    std::size_t size() const;
+
+    // Number of dependency levels
+    int depth() const;
+
+    // Compute every node through `cache` as tasks on `pool`. A node is scheduled as soon as its
+    // own inputs are ready, with no barrier between levels; OTT nodes over the same input share
+    // one batched sweep, and so do VAR nodes. Handles are released once their last consumer has run, so a memory
+    // budget still applies.
+    void execute(IndicatorCache& cache, const PriceSeries& prices, ThreadPool& pool = ThreadPool::shared()) const;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "indicators.h"
+
+// On-disk layout of a stored indicator series: the header, then `count` float64 values at
+// offset 64 (cache-line aligned in the mapping).
+struct IndicatorStoreHeader {
+    char magic[8];              // "TSOIND\0\0"
+    uint32_t version;
+    uint32_t byte_order;        // 0x01020304 in the writer's native order
+    uint32_t kind;              // IndicatorKey fields, checked against the requested key
+    int32_t length;
+    double multiplier;
+    uint64_t input;
+    uint64_t count;
+    uint64_t checksum;          // hashBytes64 of the values
+    uint64_t reserved[1];
+};
+
+// Disk tier behind IndicatorCache: a directory of content-addressed series, one file per
+// IndicatorKey id. Keys identify their inputs by content (price column checksums plus the
+// derivation chain), so any process working on the same data finds the same files. Files
+// are written to a temporary name and renamed into place, so processes sharing the
+// directory never see a partial file, and a file being replaced stays valid for whoever
+// has it mapped.
+class IndicatorStore {
+private:
+    std::string directory;
+    std::atomic<bool> write_failed;
+
+    explicit IndicatorStore(const std::string& dir);
+
+public:
+    // Bump whenever an indicator's output changes, so files from older builds are recomputed
+    static const uint32_t FORMAT_VERSION = 1;
+
+    // Open (creating it if needed) a store directory; nullptr with a message if it cannot be
+    static std::shared_ptr<IndicatorStore> open(const std::string& dir);
+
+    // Path of the file holding `key`
+    std::string path(const IndicatorKey& key) const;
+
+    // Map the stored series for `key`; false if there is none or it does not match the key
+    bool load(const IndicatorKey& key, CachedSeries& series) const;
+
+    // Store a computed series for `key` (via a temporary file and atomic rename). A failure
+    // is reported once per store; computed series stay usable either way.
+    bool save(const IndicatorKey& key, const double* values, std::size_t count);
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "price_series.h"
+
+// Where one indicator's recurrence stands just before bar `bar`: its kind-specific registers
+// and the last inputs it still looks back on. A recurrence that has not finished its warm-up
+// has no registers; its history then holds every input since bar 0.
+struct IndicatorTail {
+    uint64_t bar = 0;
+    std::vector<double> registers;
+    std::vector<double> history;
+};
+
+// Carries indicator state from one run over a growing series to the next. An IndicatorCache
+// given tails works on a window of the data that starts at absolute bar `firstBar()`: every
+// series continues from the tail the previous run captured at that bar instead of starting
+// at bar 0, and captures its own tail at window index `captureIndex()` for the next run.
+//
+// Tails are filed by recipe: the indicator key with each input named by how it derives from
+// the price columns, not by its contents, which change whenever bars are appended.
+class IndicatorTails {
+private:
+    std::size_t first_bar;
+    std::size_t capture_index;
+    std::unordered_map<uint64_t, IndicatorTail> seeds;  // Read-only while the cache runs
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, uint64_t> recipes;     // Content id -> recipe, 0 if ambiguous
+    std::unordered_map<uint64_t, IndicatorTail> captured;
+    bool incomplete;
+
+public:
+    // `previous` are the tails captured at `window_first_bar` by the last run; a window
+    // starting at bar 0 needs none
+    IndicatorTails(std::size_t window_first_bar,
+                   std::size_t capture_at,
+                   std::unordered_map<uint64_t, IndicatorTail> previous = std::unordered_map<uint64_t, IndicatorTail>());
+
+    // Name the window's price columns, the roots of every recipe
+    void addColumns(const PriceSeries& window);
+
+    std::size_t firstBar() const { return first_bar; }
+    std::size_t captureIndex() const { return capture_index; }
+
+    // Recipe of the series with content id `id`; false if it does not derive from the columns
+    bool recipeOf(uint64_t id, uint64_t& recipe) const;
+    void addRecipe(uint64_t id, uint64_t recipe);
+
+    // Tail the previous run left for `recipe`, or nullptr
+    const IndicatorTail* seed(uint64_t recipe) const;
+
+    void capture(uint64_t recipe, IndicatorTail tail);
+
+    // Some series could not be continued or could not be captured: the window's values or
+    // the captured tails are not to be trusted, and the caller should run from bar 0
+    void markIncomplete();
+    bool complete() const;
+
+    // Every tail captured so far, by recipe
+    std::unordered_map<uint64_t, IndicatorTail> capturedTails() const;
+};
@@ -2,72 +2,260 @@
 
 #include <vector>
 #include <string>
-#include <unordered_map>
+#include <cstdint>
+#include <atomic>
+#include <initializer_list>
+#include <memory>
 #include <mutex>
 #include "models.h"
+#include "indicator_tails.h"
+#include "price_series.h"
 
-// Indicator cache class
+// Immutable series held by IndicatorCache. The handle shares ownership of the buffer, so
+// its address stays valid for as long as the handle lives, even across clear().
+class CachedSeries {
+private:
+    std::shared_ptr<const double> values;
+    std::size_t len;
+    uint64_t series_id;
+
+public:
+    CachedSeries() : len(0), series_id(0) {}
+    CachedSeries(std::shared_ptr<const double> buffer, std::size_t count, uint64_t id)
+        : values(std::move(buffer)), len(count), series_id(id) {}
+
+    const double& operator[](std::size_t i) const { return values.get()[i]; }
+    const double* data() const { return values.get(); }
+    std::size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const double* begin() const { return values.get(); }
+    const double* end() const { return values.get() + len; }
+    uint64_t id() const { return series_id; }
+    const std::shared_ptr<const double>& storage() const { return values; }
+
+    // Views keep the identity, so indicators of cached series are keyed without hashing
+    operator SeriesView() const { return SeriesView(values.get(), len, series_id); }
+};
+
+// Upper and lower Bollinger bands computed together in one pass
+struct BollingerBands {
+    CachedSeries upper;
+    CachedSeries lower;
+};
+
+// Largest distance, in units in the last place, of getBollingerBands() from the bands built
+// by summing every window's squared deviations; the bench checks it before timing
+constexpr uint64_t BOLLINGER_MAX_ULPS = 2;
+
+// Kinds of series held by IndicatorCache
+enum class IndicatorKind : uint8_t {
+    Stochastic,
+    RSI,
+    VAR,
+    OTT,
+    AbsChange,
+    SumAbsChanges,
+    Highest,
+    Lowest,
+    ATR,
+    BollingerBands
+};
+
+// Cache key: indicator kind, identity of its input series and its parameters.
+// Inputs are identified by content (source checksum + derivation chain), not by size
+// or length alone, so e.g. VAR-of-RSI and VAR-of-close can never collide.
+struct IndicatorKey {
+    IndicatorKind kind;
+    uint64_t input;     // Identity of the input series (combined for multi-input indicators)
+    int length;         // Length/period parameter (0 if unused)
+    double multiplier;  // Multiplier parameter (0 if unused)
+    
+    bool operator==(const IndicatorKey& other) const {
+        return kind == other.kind && input == other.input &&
+               length == other.length && multiplier == other.multiplier;
+    }
+    
+    // Stable identity of the series this key produces
+    uint64_t id() const;
+};
+
+class IndicatorStore;
+
+// One computation's part in a windowed run: the tail it continues from and where it captures
+// its own (defined in indicators.cpp)
+struct IndicatorTailLink;
+
+// Indicator cache class. Lookups of series that are already cached take no shared lock and do
+// no atomic read-modify-write on memory other threads use: each thread hands out copies of its
+// own handle to the series. A missing series is computed exactly once, by the first thread
+// that asks for it, while other threads asking for the same key wait for that result.
 class IndicatorCache {
+public:
+    // Bump whenever an indicator's output or the registers its tail keeps change, so saved
+    // run states from older builds are not continued
+    static const uint32_t OUTPUT_VERSION = 1;
+
 private:
-    // Cache for VAR (VIDYA) calculations with different lengths
-    std::unordered_map<int, std::vector<double>> var_cache;
+    struct Entry;
+    struct Table;
+    struct Readers;
+    class Claim;
+    
+    // Open-addressing table of entries. Readers probe it without locking; inserts and growth
+    // happen under insert_mutex, and a grown table is published only once it is complete.
+    std::atomic<Table*> table;
     
-    // Cache for OTT calculations with different multiplier values
-    std::unordered_map<std::pair<int, double>, std::vector<double>, PairHash> ott_cache;
+    // Every table ever published (old ones may still be probed by readers) and every entry
+    std::vector<std::unique_ptr<Table>> tables;
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::mutex insert_mutex;
     
-    // General purpose indicator cache for stochastic, RSI, etc.
-    std::unordered_map<std::string, std::vector<double>> indicator_cache;
+    // Per-thread handles and hit counts of every thread that has read from this cache; a
+    // thread finds its own through a thread-local pointer tagged with cache_id
+    const uint64_t cache_id;
+    std::vector<std::unique_ptr<Readers>> readers;
+    mutable std::mutex readers_mutex;   // Taken once per thread, and by evict(), clear() and getStats()
     
-    // Common calculations used by multiple indicators
-    std::unordered_map<int, std::vector<double>> abs_change_cache;
-    std::unordered_map<int, std::vector<double>> sum_abs_changes_cache;
-    std::unordered_map<int, std::vector<double>> highest_cache;
-    std::unordered_map<int, std::vector<double>> lowest_cache;
-    std::unordered_map<int, std::vector<double>> atr_cache;
+    Readers& localReaders();
     
-    // Thread safety
-    std::mutex cache_mutex;
+    // Copy the calling thread's handle to a ready entry's series into `values`, making the
+    // handle on the thread's first read; false if the entry is no longer ready
+    bool readHandle(Entry* entry, std::shared_ptr<const double>& values);
+    
+    // Memory budget for resident series (0 = unlimited) and usage/effectiveness counters
+    const std::size_t budget_bytes;
+    std::atomic<std::size_t> resident_bytes;
+    std::atomic<std::size_t> peak_bytes;
+    std::atomic<uint64_t> access_clock;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> evictions;
+    // Resident size below which addResident() does not scan again after a scan that could not
+    // get back within budget (everything left was pinned)
+    std::atomic<std::size_t> next_eviction_scan;
+    std::atomic<uint64_t> store_loads;
+    std::atomic<uint64_t> store_saves;
+    
+    void countMiss();
+    void addResident(std::size_t bytes);
+    
+    // Drop least recently used, largest series that no handle refers to until the resident
+    // size is back within budget. A scan that falls short is not repeated until another
+    // eighth of the budget has been added.
+    void evict();
+    
+    // Identity of an input series: the id its owner gave the view. Only a scratch view
+    // (id 0) would be hashed here, and no caller passes one.
+    uint64_t identify(SeriesView data);
+    
+    // Disk tier that missing series are loaded from and computed series are written to, or null
+    std::shared_ptr<IndicatorStore> store;
+    
+    // Tails of a run over a window of a growing series (see IndicatorTails), or null
+    std::shared_ptr<IndicatorTails> tails;
+    
+    // Where the computation of `key` from series of `length` bars continues from and what it
+    // captures; `inputs` are the ids its key's input was combined from
+    IndicatorTailLink tailLink(const IndicatorKey& key, std::initializer_list<uint64_t> inputs, std::size_t length);
+    
+    Entry* findEntry(const IndicatorKey& key) const;
+    // Returns the entry for `key`, creating it (in the Computing state) if needed
+    Entry* insertEntry(const IndicatorKey& key, bool& created);
 
 public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t store_loads;   // Misses served from the store instead of computed
+        uint64_t store_saves;
+        std::size_t resident_bytes;
+        std::size_t peak_bytes;
+        std::size_t budget_bytes;
+        
+        // Totals of several caches, e.g. the NUMA shards and the shared cache
+        Stats& operator+=(const Stats& other) {
+            hits += other.hits;
+            misses += other.misses;
+            evictions += other.evictions;
+            store_loads += other.store_loads;
+            store_saves += other.store_saves;
+            resident_bytes += other.resident_bytes;
+            peak_bytes += other.peak_bytes;
+            budget_bytes += other.budget_bytes;
+            return *this;
+        }
+    };
+    
+    // A non-zero budget bounds the bytes of cached series; series that are still referenced
+    // by a handle are never evicted, so usage can exceed the budget while they are in use
+    explicit IndicatorCache(std::size_t memory_budget_bytes = 0);
+    ~IndicatorCache();
+    
+    IndicatorCache(const IndicatorCache&) = delete;
+    IndicatorCache& operator=(const IndicatorCache&) = delete;
+    
+    // Look series up in `disk_store` before computing them and write them to it afterwards.
+    // Set it before the first lookup. A cache with tails neither reads nor writes it.
+    void setStore(std::shared_ptr<IndicatorStore> disk_store) { store = std::move(disk_store); }
+    
+    // Compute every series as a window of a longer one, continuing from and capturing tails.
+    // Set it before the first lookup; all inputs must then derive from the window's columns.
+    void setTails(std::shared_ptr<IndicatorTails> window_tails) { tails = std::move(window_tails); }
+    
     // Get or calculate Stochastic indicator
-    const std::vector<double>& getStochastic(const std::vector<double>& closes, 
-                                           const std::vector<double>& highs, 
-                                           const std::vector<double>& lows, 
-                                           int k_length);
+    CachedSeries getStochastic(SeriesView closes, 
+                               SeriesView highs, 
+                               SeriesView lows, 
+                               int k_length);
     
     // Get or calculate RSI indicator
-    const std::vector<double>& getRSI(const std::vector<double>& closes, int length);
+    CachedSeries getRSI(SeriesView closes, int length);
     
     // Get or calculate VAR indicator (VIDYA)
-    const std::vector<double>& getVAR(const std::vector<double>& data, int length);
+    CachedSeries getVAR(SeriesView data, int length);
+    
+    // Get or calculate VAR for several lengths over the same series in one sweep, sharing the
+    // efficiency ratio; results are returned in the order of `lengths`
+    std::vector<CachedSeries> getVARBatch(SeriesView data, const std::vector<int>& lengths);
     
     // Get or calculate OTT indicator
-    const std::vector<double>& getOTT(const std::vector<double>& data, double multiplier);
+    CachedSeries getOTT(SeriesView data, double multiplier);
+    
+    // Get or calculate OTT for a whole multiplier grid over the same series in one sweep;
+    // results are returned in the order of `multipliers`
+    std::vector<CachedSeries> getOTTBatch(SeriesView data, const std::vector<double>& multipliers);
     
     // Get or calculate absolute change
-    const std::vector<double>& getAbsChange(const std::vector<double>& data, int period);
+    CachedSeries getAbsChange(SeriesView data, int period);
     
     // Get or calculate sum of absolute changes
-    const std::vector<double>& getSumAbsChanges(const std::vector<double>& data, int period);
+    CachedSeries getSumAbsChanges(SeriesView data, int period);
     
     // Get or calculate highest over period
-    const std::vector<double>& getHighest(const std::vector<double>& data, int period);
+    CachedSeries getHighest(SeriesView data, int period);
     
     // Get or calculate lowest over period
-    const std::vector<double>& getLowest(const std::vector<double>& data, int period);
+    CachedSeries getLowest(SeriesView data, int period);
     
     // Get or calculate ATR (Average True Range)
-    const std::vector<double>& getATR(const std::vector<double>& highs, 
-                                    const std::vector<double>& lows, 
-                                    const std::vector<double>& closes, 
-                                    int period);
+    CachedSeries getATR(SeriesView highs, 
+                        SeriesView lows, 
+                        SeriesView closes, 
+                        int period);
+    
+    // Get or calculate both Bollinger Bands around the VAR basis in a single pass
+    BollingerBands getBollingerBands(SeriesView data, int length, double multiplier);
     
     // Get or calculate Bollinger Bands upper
-    const std::vector<double>& getBBUpper(const std::vector<double>& data, int length, double multiplier);
+    CachedSeries getBBUpper(SeriesView data, int length, double multiplier);
     
     // Get or calculate Bollinger Bands lower
-    const std::vector<double>& getBBLower(const std::vector<double>& data, int length, double multiplier);
+    CachedSeries getBBLower(SeriesView data, int length, double multiplier);
+    
+    // Snapshot of the cache counters
+    Stats getStats() const;
     
-    // Clear all caches to free memory
+    // Clear all caches to free memory. Handles already returned stay valid, but no getter
+    // may run concurrently with clear().
     void clear();
-};
\ No newline at end of file
+};
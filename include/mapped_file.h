@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+
+// Read-only memory mapping of a whole file (falls back to a heap copy where mmap is unavailable)
+class MappedFile {
+private:
+    const char* data_ptr;
+    std::size_t data_size;
+    bool is_open;
+    bool is_mapped;
+    std::string fallback_buffer;
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map the file; returns false if it cannot be opened
+    bool open(const std::string& filename);
+
+    // Unmap the file and release any fallback buffer
+    void close();
+
+    const char* data() const { return data_ptr; }
+    std::size_t size() const { return data_size; }
+    bool isOpen() const { return is_open; }
+};
+
+// Name to write `path` under before renaming it into place. Names must not collide between
+// threads or between processes sharing a directory (forked ones included), so each call draws
+// a fresh random suffix.
+std::string temporaryPath(const std::string& path);
+
+// Write `path` through `writer` into a temporary file next to it and rename that into place,
+// so readers never see a partial file. Returns false, leaving no temporary file behind, if
+// the file cannot be created, the stream fails or the rename fails; callers report it.
+bool writeFileAtomically(const std::string& path, const std::function<void(std::ostream&)>& writer);
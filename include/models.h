@@ -3,9 +3,11 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <sstream>
 #include <cmath>
 #include <limits>
 #include <unordered_map>
+#include "param_key.h"
 
 // Basic data structures
 struct Bar {
@@ -37,10 +39,11 @@ struct BacktestResult {
     double max_drawdown;
     double profit_percent;
     std::vector<Trade> trades;
-    std::string params_str;
+    std::string params_str;    // Built from param_key by ParamGrid::describe on export
     std::string strategy_name;
     int sl_trades;         // Number of trades that hit stop loss
     double sl_win_rate;    // Win rate excluding stop loss trades
+    ParamKey param_key;    // Grid combination that produced this result
 };
 
 // Custom hash for pair
@@ -53,7 +56,8 @@ struct PairHash {
     }
 };
 
-// Base Strategy Parameters class
+// Base Strategy Parameters class. Grids identify combinations by ParamKey; these structs only
+// format the parameter strings of exported results (see ParamGrid::describe).
 struct StrategyParams {
     double sl_percent;     // Stop loss percentage
     double tp_percent;     // Take profit percentage
@@ -64,26 +68,6 @@ struct StrategyParams {
     
     virtual ~StrategyParams() = default;
     
-    // Base hash function for parameter caching
-    virtual std::size_t hash() const {
-        std::size_t h = std::hash<double>{}(sl_percent);
-        h ^= std::hash<double>{}(tp_percent) + 0x9e3779b9 + (h << 6) + (h >> 2);
-        h ^= std::hash<bool>{}(use_sl) + 0x9e3779b9 + (h << 6) + (h >> 2);
-        h ^= std::hash<bool>{}(use_tp) + 0x9e3779b9 + (h << 6) + (h >> 2);
-        h ^= std::hash<bool>{}(pyramiding) + 0x9e3779b9 + (h << 6) + (h >> 2);
-        h ^= std::hash<std::string>{}(strategy_name) + 0x9e3779b9 + (h << 6) + (h >> 2);
-        return h;
-    }
-    
-    virtual bool operator==(const StrategyParams& other) const {
-        return sl_percent == other.sl_percent &&
-               tp_percent == other.tp_percent &&
-               use_sl == other.use_sl &&
-               use_tp == other.use_tp &&
-               pyramiding == other.pyramiding &&
-               strategy_name == other.strategy_name;
-    }
-    
     // Virtual function to get parameter string
     virtual std::string getParamString() const {
         std::ostringstream params_ss;
@@ -104,8 +88,6 @@ struct OttParams : public StrategyParams {
         strategy_name = "OTT";
     }
     
-    std::size_t hash() const override;
-    bool operator==(const OttParams& other) const;
     std::string getParamString() const override;
 };
 
@@ -118,8 +100,6 @@ struct TottParams : public StrategyParams {
         strategy_name = "TOTT";
     }
     
-    std::size_t hash() const override;
-    bool operator==(const TottParams& other) const;
     std::string getParamString() const override;
 };
 
@@ -135,8 +115,6 @@ struct OttChannelParams : public StrategyParams {
         channel_type = "Half Channel"; // Default value
     }
     
-    std::size_t hash() const override;
-    bool operator==(const OttChannelParams& other) const;
     std::string getParamString() const override;
 };
 
@@ -149,8 +127,6 @@ struct RisottoParams : public StrategyParams {
         strategy_name = "RISOTTO";
     }
     
-    std::size_t hash() const override;
-    bool operator==(const RisottoParams& other) const;
     std::string getParamString() const override;
 };
 
@@ -163,8 +139,6 @@ struct SottParams : public StrategyParams {
         strategy_name = "SOTT";
     }
     
-    std::size_t hash() const override;
-    bool operator==(const SottParams& other) const;
     std::string getParamString() const override;
 };
 
@@ -180,8 +154,6 @@ struct HottLottParams : public StrategyParams {
         sum_n_bars = 3;
     }
     
-    std::size_t hash() const override;
-    bool operator==(const HottLottParams& other) const;
     std::string getParamString() const override;
 };
 
@@ -193,8 +165,6 @@ struct RottParams : public StrategyParams {
         strategy_name = "ROTT";
     }
     
-    std::size_t hash() const override;
-    bool operator==(const RottParams& other) const;
     std::string getParamString() const override;
 };
 
@@ -207,8 +177,6 @@ struct FtParams : public StrategyParams {
         strategy_name = "FT";
     }
     
-    std::size_t hash() const override;
-    bool operator==(const FtParams& other) const;
     std::string getParamString() const override;
 };
 
@@ -220,8 +188,6 @@ struct RtrParams : public StrategyParams {
         strategy_name = "RTR";
     }
     
-    std::size_t hash() const override;
-    bool operator==(const RtrParams& other) const;
     std::string getParamString() const override;
 };
 
@@ -235,8 +201,6 @@ struct MottParams : public StrategyParams {
         strategy_name = "MOTT";
     }
     
-    std::size_t hash() const override;
-    bool operator==(const MottParams& other) const;
     std::string getParamString() const override;
 };
 
@@ -249,7 +213,5 @@ struct BootsParams : public StrategyParams {
         strategy_name = "BOOTS";
     }
     
-    std::size_t hash() const override;
-    bool operator==(const BootsParams& other) const;
     std::string getParamString() const override;
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "indicators.h"
+#include "price_series.h"
+#include "thread_pool.h"
+
+// Thin wrapper over libnuma. Built without it (no HAVE_LIBNUMA) or on a machine without NUMA
+// support, the machine looks like a single node and every call is a harmless no-op.
+class NumaTopology {
+public:
+    static bool available();
+    static int nodeCount();
+
+    // Ids of the nodes that have CPUs, ascending; node ids may have gaps and memory-only
+    // nodes cannot run workers. {0} without NUMA support.
+    static std::vector<int> cpuNodes();
+
+    // Restrict the calling thread to the CPUs of `node` and prefer its memory
+    static bool bindCurrentThread(int node);
+
+    // Page-aligned memory on `node` (plain heap memory without NUMA or for a negative node);
+    // free with release() and the same size and node
+    static void* allocate(std::size_t bytes, int node);
+    static void release(void* memory, std::size_t bytes, int node);
+};
+
+// Per-node copies of what the backtests read: a replica of the price columns, an indicator
+// cache shard and a pool of workers pinned to the node. Work split across the nodes then
+// only touches local memory; indicators are computed once per node instead of crossing the
+// interconnect on every read.
+class NumaShards {
+public:
+    struct Shard {
+        int node;                                   // -1 for an emulated node
+        std::shared_ptr<const PriceSeries> prices;
+        std::shared_ptr<IndicatorCache> cache;
+        std::unique_ptr<ThreadPool> pool;
+    };
+
+private:
+    std::vector<Shard> shards;
+
+    NumaShards() = default;
+
+public:
+    // One shard per NUMA node with CPUs, with `num_threads` workers and `cache_budget_bytes`
+    // of cache budget divided between them. Returns nullptr when there is only one such node
+    // (or no NUMA support), in which case callers keep using the shared data and pool. With
+    // `emulated_nodes` > 0, that many shards are built on heap memory and unpinned pools
+    // instead, so the split can be exercised on any machine (e.g. by bench).
+    static std::shared_ptr<NumaShards> create(const PriceSeries& prices, int num_threads,
+                                              std::size_t cache_budget_bytes, int emulated_nodes = 0);
+
+    std::size_t size() const { return shards.size(); }
+    Shard& shard(std::size_t index) { return shards[index]; }
+    const Shard& shard(std::size_t index) const { return shards[index]; }
+
+    // Shard whose pool the calling thread works for, or nullptr outside the shard pools
+    const Shard* current() const;
+
+    // Index of current(), or size() outside the shard pools
+    std::size_t currentIndex() const;
+
+    // Statistics of all cache shards added together
+    IndicatorCache::Stats cacheStats() const;
+};
@@ -11,16 +11,23 @@
 #include <filesystem>
 #include "models.h"
 #include "indicators.h"
+#include "indicator_plan.h"
+#include "thread_pool.h"
+#include "numa_topology.h"
+#include "result_collector.h"
+#include "walk_forward.h"
+#include "incremental_run.h"
 #include "backtester.h"
+#include "price_series.h"
 
 // Base optimizer class
 class StrategyOptimizer {
 protected:
-    const std::vector<Bar>& bars;
-    std::vector<double> closes; // Pre-extracted price data
-    std::vector<double> highs;
-    std::vector<double> lows;
-    std::vector<double> opens;
+    std::shared_ptr<const PriceSeries> prices; // Shared, immutable price columns
+    SeriesView closes;
+    SeriesView highs;
+    SeriesView lows;
+    SeriesView opens;
     
     std::vector<double> sl_percents;
     std::vector<double> tp_percents;
@@ -32,20 +39,23 @@ protected:
     double min_win_rate;
     bool exclude_sl_from_winrate;
     std::shared_ptr<IndicatorCache> cache;
+    std::shared_ptr<NumaShards> numa_shards;   // Per-node replicas in NUMA mode, else null
     
     std::atomic<int> progress;
     int total_combinations;
     
-    std::mutex result_mutex;
-    std::mutex progress_mutex;
+    // Passing results and duplicate detection, per optimize() call; lock-free on the hot path
+    std::unique_ptr<ResultCollector> collector;
+    
+    // Run the signal variants over the window of the series from `state`'s capture bar on,
+    // continuing its lanes and indicator tails (from bar 0 when it has not started), and
+    // leave the state at the end of the series. False if it could not be continued exactly.
+    bool continueRun(RunState& state, uint64_t grid, std::vector<BacktestResult>& results);
     
-    // Result deduplication
-    std::unordered_map<std::string, bool> result_deduplication;
-    std::mutex dedup_mutex;
     
 public:
     StrategyOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<double>& sl_pcts = {1.0, 2.0, 3.0},
         const std::vector<double>& tp_pcts = {2.0, 3.0, 5.0},
         bool enable_sl = true,
@@ -59,20 +69,101 @@ public:
     
     virtual ~StrategyOptimizer() = default;
     
-    // Method to save results to CSV by strategy
+    // Replace the SL/TP grid, trade switches and result filters given at construction, e.g.
+    // for an optimizer built with its default parameter grid
+    void setTradeSettings(const std::vector<double>& sl_pcts,
+                          const std::vector<double>& tp_pcts,
+                          bool enable_sl,
+                          bool enable_tp,
+                          bool enable_pyramiding,
+                          double capital,
+                          int minimum_trades,
+                          double minimum_win_rate,
+                          bool exclude_sl);
+    
+    // Share one indicator cache between optimizers; entries are keyed by input identity,
+    // so strategies over the same data reuse each other's series safely
+    void setIndicatorCache(std::shared_ptr<IndicatorCache> shared_cache) { cache = std::move(shared_cache); }
+    
+    // Enable NUMA mode: combinations are split across the nodes' pinned pools, and each
+    // backtest reads the price replica and cache shard of the node it runs on
+    void setNumaShards(std::shared_ptr<NumaShards> shards) { numa_shards = std::move(shards); }
+    
+    // Price data and indicator cache to read from the calling thread: the local node's
+    // replica and shard in NUMA mode, the shared ones otherwise
+    const PriceSeries& localPrices() const;
+    IndicatorCache& localCache() const;
+    
+    // One simulator per NUMA shard over its price replica, each built by the shard's own
+    // workers so its level index lands in local memory; empty outside NUMA mode. Index it
+    // with NumaShards::currentIndex().
+    std::vector<std::unique_ptr<TradeSimulator>> shardSimulators() const;
+    
+    // Whether paramGrid() fits a ParamKey (see ParamGrid::fitsParamKey); reports why not.
+    // Every run checks this first, so keys never alias combinations.
+    bool checkParamGrid() const;
+    
+    // Method to save results to CSV by strategy; describe the results first (see paramGrid())
     static void saveResultsToCSV(const std::vector<BacktestResult>& results, 
                                const std::string& strategy_name, 
                                const std::string& base_dir = "results");
     
     // Method to save trades for top results
     static void saveTradesForTopResults(const std::vector<BacktestResult>& results, 
-                                      const std::vector<Bar>& bars, 
+                                      const PriceSeries& prices, 
                                       const std::string& strategy_name,
                                       const std::string& sort_by = "win_rate", 
                                       int num_top = 10,
                                       const std::string& base_dir = "results");
     
-    virtual std::vector<BacktestResult> optimize(int num_threads = 4) = 0;
+    // Fill in the trade lists of the results saveTradesForTopResults() would pick with the
+    // same arguments; optimize() keeps metrics only
+    void replayTopTrades(std::vector<BacktestResult>& results, const std::string& sort_by = "win_rate", int num_top = 10);
+    
+    // Declare every indicator the parameter grid will read, so they can be computed up front
+    virtual void planIndicators(IndicatorPlan&) const {}
+    
+    // Compute the planned indicators on the shared thread pool before any backtest runs;
+    // returns the seconds spent so the indicator and simulation phases can be told apart
+    double precomputeIndicators();
+    
+    // Evaluate combinations [0, count) as small tasks on the shared thread pool and return
+    // once all are done, advancing `progress` as chunks finish. Strategies optimized from
+    // different threads share the pool, so one strategy's tail overlaps the next one's work.
+    // In NUMA mode each node's pool takes a contiguous share sized by its worker count.
+    void forEachCombination(std::size_t count, const std::function<void(std::size_t)>& evaluate);
+    
+    // Simulate every signal variant across the SL x TP grid and keep the results that pass
+    // the filters. Results carry their ParamKey and metrics only; params_str is filled on
+    // export through paramGrid().describeAll(). Parallel work runs on the shared pool (or the
+    // NUMA shard pools), whose size is set once per process with ThreadPool::setSharedSize.
+    virtual std::vector<BacktestResult> optimize();
+    
+    // The strategy's own parameter grid (without SL/TP) as signal variants for walk-forward
+    // runs: how many there are, the key of each, and its full-length direction vector read
+    // from the indicator cache. Strategies that do not override these cannot walk forward.
+    virtual std::size_t signalVariants() const { return 0; }
+    virtual ParamKey variantKey(std::size_t) const { return ParamKey(); }
+    virtual bool variantSignals(std::size_t, std::vector<int>&) const { return false; }
+    
+    // How many bars before a bar its direction may depend on beyond the indicator values at
+    // that bar (e.g. a count of consecutive bars), over the whole grid. Incremental runs
+    // recompute signals over RunState::OVERLAP_BARS bars and need this to fit in them.
+    virtual std::size_t signalLookback() const { return 0; }
+    
+    // Values behind the grid indices of variantKey() plus SL and TP, to describe keys on export
+    virtual ParamGrid paramGrid() const = 0;
+    
+    // Walk-forward optimization over rolling in-sample/out-of-sample windows. The planned
+    // indicators are computed once over the full history and shared by every window.
+    std::vector<WalkForwardWindow> walkForward(const WalkForwardConfig& config);
+    
+    // The passing results of optimize(), continued from the run state saved at `state_path`
+    // when the series only grew since: only the appended bars (and a short overlap) are
+    // computed and simulated. The state is then saved for the next run. Falls back to a run
+    // from bar 0 when there is no usable state, and to optimize() for strategies without
+    // signal variants or whose signalLookback() does not fit in the overlap. Results carry their param_key; params_str is filled on export.
+    std::vector<BacktestResult> optimizeIncremental(const std::string& state_path);
 };
 
 // Strategy-specific optimizer classes
@@ -81,9 +172,11 @@ private:
     std::vector<int> support_lengths;
     std::vector<double> ott_multipliers;
     
+    OttParams variantParams(std::size_t variant) const;
+    
 public:
     OttOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& support_lens = {10, 20, 30, 40, 50},
         const std::vector<double>& ott_mults = {0.5, 0.7, 0.9, 1.1, 1.3, 1.5},
         const std::vector<double>& sl_pcts = {1.0, 2.0, 3.0},
@@ -97,7 +190,11 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
 };
 
 class TottOptimizer : public StrategyOptimizer {
@@ -106,9 +203,11 @@ private:
     std::vector<double> ott_multipliers;
     std::vector<double> band_multipliers;
     
+    TottParams variantParams(std::size_t variant) const;
+    
 public:
     TottOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& support_lens = {20, 30, 40, 50},
         const std::vector<double>& ott_mults = {0.3, 0.4, 0.5, 0.6},
         const std::vector<double>& band_mults = {0.0004, 0.0005, 0.0006},
@@ -123,7 +222,11 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
 };
 
 class SottOptimizer : public StrategyOptimizer {
@@ -132,9 +235,11 @@ private:
     std::vector<int> stoch_d_lengths;
     std::vector<double> ott_multipliers;
     
+    SottParams variantParams(std::size_t variant) const;
+    
 public:
     SottOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& stoch_k_lens = {200, 300, 400, 500},
         const std::vector<int>& stoch_d_lens = {100, 150, 200},
         const std::vector<double>& ott_mults = {0.5, 0.6, 0.7, 0.8, 0.9, 1.0},
@@ -149,7 +254,11 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
 };
 
 class OttChannelOptimizer : public StrategyOptimizer {
@@ -160,9 +269,11 @@ private:
     std::vector<double> lower_multipliers;
     std::vector<std::string> channel_types;
     
+    OttChannelParams variantParams(std::size_t variant) const;
+    
 public:
     OttChannelOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& ma_lens = {10, 20, 30, 40, 50},
         const std::vector<double>& ott_mults = {0.3, 0.5, 0.7, 0.9},
         const std::vector<double>& upper_mults = {0.1, 0.2, 0.3, 0.4, 0.5},
@@ -179,7 +290,11 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
 };
 
 class RisottoOptimizer : public StrategyOptimizer {
@@ -188,9 +303,11 @@ private:
     std::vector<int> support_lengths;
     std::vector<double> ott_multipliers;
     
+    RisottoParams variantParams(std::size_t variant) const;
+    
 public:
     RisottoOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& rsi_lens = {8, 12, 16, 20, 24},
         const std::vector<int>& support_lens = {10, 20, 30, 40, 50},
         const std::vector<double>& ott_mults = {0.5, 0.7, 0.9, 1.1, 1.3, 1.5},
@@ -205,7 +322,11 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
 };
 
 class HottLottOptimizer : public StrategyOptimizer {
@@ -215,9 +336,11 @@ private:
     std::vector<bool> use_sum_values;
     std::vector<int> sum_n_bars_values;
     
+    HottLottParams variantParams(std::size_t variant) const;
+    
 public:
     HottLottOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& hl_lens = {5, 10, 15, 20, 25, 30},
         const std::vector<double>& ott_mults = {0.5, 0.7, 0.9, 1.1, 1.3, 1.5},
         const std::vector<bool>& use_sum_opts = {false, true},
@@ -233,7 +356,12 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
+    std::size_t signalLookback() const override;
 };
 
 class RottOptimizer : public StrategyOptimizer {
@@ -241,9 +369,11 @@ private:
     std::vector<int> support_lengths;
     std::vector<double> ott_multipliers;
     
+    RottParams variantParams(std::size_t variant) const;
+    
 public:
     RottOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& support_lens = {10, 15, 20, 25, 30, 35, 40, 45, 50},
         const std::vector<double>& ott_mults = {0.5, 0.7, 0.9, 1.1, 1.3, 1.5},
         const std::vector<double>& sl_pcts = {1.0, 2.0, 3.0},
@@ -257,7 +387,11 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
 };
 
 class FtOptimizer : public StrategyOptimizer {
@@ -266,9 +400,11 @@ private:
     std::vector<double> major_multipliers;
     std::vector<double> minor_multipliers;
     
+    FtParams variantParams(std::size_t variant) const;
+    
 public:
     FtOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& support_lens = {10, 20, 30, 40, 50},
         const std::vector<double>& major_mults = {0.5, 0.7, 0.9, 1.1, 1.3, 1.5},
         const std::vector<double>& minor_mults = {0.1, 0.3, 0.5, 0.7, 0.9},
@@ -283,7 +419,11 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
 };
 
 class RtrOptimizer : public StrategyOptimizer {
@@ -291,9 +431,11 @@ private:
     std::vector<int> atr_lengths;
     std::vector<int> ma_lengths;
     
+    RtrParams variantParams(std::size_t variant) const;
+    
 public:
     RtrOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& atr_lens = {5, 10, 15, 20, 25, 30},
         const std::vector<int>& ma_lens = {10, 15, 20, 25, 30, 35, 40, 45, 50},
         const std::vector<double>& sl_pcts = {1.0, 2.0, 3.0},
@@ -307,7 +449,11 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
 };
 
 class MottOptimizer : public StrategyOptimizer {
@@ -317,9 +463,11 @@ private:
     std::vector<double> ott_multipliers;
     std::vector<int> reference_values;
     
+    MottParams variantParams(std::size_t variant) const;
+    
 public:
     MottOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& support_lens = {10, 20, 30, 40, 50},
         const std::vector<int>& hl_lens = {5, 10, 15, 20, 25, 30},
         const std::vector<double>& ott_mults = {0.5, 0.7, 0.9, 1.1, 1.3, 1.5},
@@ -335,7 +483,11 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
 };
 
 class BootsOptimizer : public StrategyOptimizer {
@@ -344,9 +496,11 @@ private:
     std::vector<int> bb_lengths;
     std::vector<double> ott_multipliers;
     
+    BootsParams variantParams(std::size_t variant) const;
+    
 public:
     BootsOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<int>& support_lens = {10, 20, 30, 40, 50},
         const std::vector<int>& bb_lens = {10, 20, 30, 40, 50},
         const std::vector<double>& ott_mults = {0.5, 0.7, 0.9, 1.1, 1.3, 1.5},
@@ -361,13 +515,20 @@ public:
         bool exclude_sl = false
     );
     
-    std::vector<BacktestResult> optimize(int num_threads = 4) override;
+    void planIndicators(IndicatorPlan& plan) const override;
+    ParamGrid paramGrid() const override;
+    std::size_t signalVariants() const override;
+    ParamKey variantKey(std::size_t variant) const override;
+    bool variantSignals(std::size_t variant, std::vector<int>& dir) const override;
 };
 
+// Optimizer over the default grid of a strategy
+std::unique_ptr<StrategyOptimizer> createOptimizer(StrategyId id, std::shared_ptr<const PriceSeries> prices);
+
 // Multi-strategy optimizer class
 class MultiStrategyOptimizer {
 private:
-    std::vector<Bar> bars;
+    std::shared_ptr<const PriceSeries> prices;
     std::vector<std::string> selected_strategies;
     std::vector<double> sl_percents;
     std::vector<double> tp_percents;
@@ -378,11 +539,21 @@ private:
     int min_trades;
     double min_win_rate;
     bool exclude_sl_from_winrate;
-    int num_threads;
+    
+    // Indicator cache shared by every strategy in the run
+    std::shared_ptr<IndicatorCache> cache;
+    std::shared_ptr<NumaShards> numa_shards;
+    
+    // Directory of per-strategy run states for incremental runs; empty runs every grid in full
+    std::string state_dir;
+    
+    // Walk-forward layout; strategies are optimized over the whole series when its in-sample
+    // length is 0
+    WalkForwardConfig walk_forward;
     
 public:
     MultiStrategyOptimizer(
-        const std::vector<Bar>& price_data,
+        std::shared_ptr<const PriceSeries> price_series,
         const std::vector<std::string>& strategies,
         const std::vector<double>& sl_pcts = {1.0, 2.0, 3.0},
         const std::vector<double>& tp_pcts = {2.0, 3.0, 5.0},
@@ -392,9 +563,21 @@ public:
         double capital = 10000.0,
         int minimum_trades = 5,
         double minimum_win_rate = 50.0,
-        bool exclude_sl = false,
-        int threads = 4
+        bool exclude_sl = false
     );
     
+    // Replace the indicator cache shared by the strategies (e.g. with a memory-budgeted one)
+    void setIndicatorCache(std::shared_ptr<IndicatorCache> shared_cache) { cache = std::move(shared_cache); }
+    
+    // Run every strategy in NUMA mode on these shards (see StrategyOptimizer::setNumaShards)
+    void setNumaShards(std::shared_ptr<NumaShards> shards) { numa_shards = std::move(shards); }
+    
+    // Continue every strategy from its state in `dir` (see StrategyOptimizer::optimizeIncremental)
+    void setStateDirectory(const std::string& dir) { state_dir = dir; }
+    
+    // Walk every strategy forward instead (see StrategyOptimizer::walkForward); the result
+    // filters given at construction apply to the in-sample picks
+    void setWalkForward(const WalkForwardConfig& config) { walk_forward = config; }
+    
     void optimizeAll();
 };
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Strategies a ParamKey can belong to, in the order of the optimizer list
+enum class StrategyId : uint8_t {
+    OTT,
+    TOTT,
+    OTT_CHANNEL,
+    RISOTTO,
+    SOTT,
+    HOTT_LOTT,
+    ROTT,
+    FT,
+    RTR,
+    MOTT,
+    BOOTS
+};
+
+// Compact identity of one grid combination: the strategy, the SL/TP/pyramiding switches and
+// the grid index of every parameter, the strategy's own dimensions first and then SL and TP.
+// Trivially copyable and half a cache line, so it is cheap to store per result, and hashing
+// and comparison are constexpr. The readable parameter string is only built on export, from
+// a ParamGrid.
+struct ParamKey {
+    static constexpr int MAX_DIMENSIONS = 14;
+    static constexpr std::size_t MAX_VALUES = 65536;   // Per dimension; indices are 16 bits
+    static constexpr uint8_t USE_SL = 1;
+    static constexpr uint8_t USE_TP = 2;
+    static constexpr uint8_t PYRAMIDING = 4;
+
+    uint8_t strategy;
+    uint8_t dimensions;
+    uint8_t flags;
+    uint8_t reserved;
+    uint16_t index[MAX_DIMENSIONS];
+
+    constexpr ParamKey() : strategy(0), dimensions(0), flags(0), reserved(0), index{} {}
+
+    constexpr ParamKey(StrategyId id, uint8_t switches, std::initializer_list<uint16_t> indices)
+        : strategy(static_cast<uint8_t>(id)), dimensions(0), flags(switches), reserved(0), index{} {
+        for (uint16_t i : indices) {
+            if (dimensions < MAX_DIMENSIONS) {
+                index[dimensions++] = i;
+            }
+        }
+    }
+
+    constexpr StrategyId strategyId() const { return static_cast<StrategyId>(strategy); }
+
+    // splitmix64 over the packed fields, four indices per word
+    constexpr uint64_t hash() const {
+        uint64_t h = (uint64_t(strategy) << 16) | (uint64_t(dimensions) << 8) | flags;
+        for (int i = 0; i < MAX_DIMENSIONS; i += 4) {
+            uint64_t word = 0;
+            for (int j = 0; j < 4 && i + j < MAX_DIMENSIONS; ++j) {
+                word |= uint64_t(index[i + j]) << (16 * j);
+            }
+            h = mix(h ^ (word + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2)));
+        }
+        return h;
+    }
+
+    constexpr bool operator==(const ParamKey& other) const {
+        if (strategy != other.strategy || dimensions != other.dimensions || flags != other.flags) {
+            return false;
+        }
+        for (int i = 0; i < dimensions; ++i) {
+            if (index[i] != other.index[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool operator!=(const ParamKey& other) const { return !(*this == other); }
+
+private:
+    static constexpr uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+};
+
+static_assert(std::is_trivially_copyable<ParamKey>::value, "ParamKey must stay a plain value");
+static_assert(sizeof(ParamKey) <= 32, "ParamKey must fit in half a cache line");
+static_assert(ParamKey(StrategyId::OTT, 0, {1, 2}) == ParamKey(StrategyId::OTT, 0, {1, 2}) &&
+              ParamKey(StrategyId::OTT, 0, {1, 2}).hash() != ParamKey(StrategyId::OTT, 0, {2, 1}).hash(),
+              "ParamKey hashing and equality are evaluated at compile time");
+
+struct ParamKeyHash {
+    constexpr std::size_t operator()(const ParamKey& key) const { return static_cast<std::size_t>(key.hash()); }
+};
+
+struct BacktestResult;
+
+// The values behind a strategy's grid indices. Dimensions are listed in ParamKey order (the
+// strategy's own parameters, then SL and TP); a text dimension such as the OTT_CHANNEL
+// channel type uses `labels` instead of `values`.
+class ParamGrid {
+public:
+    struct Dimension {
+        std::vector<double> values;
+        std::vector<std::string> labels;
+    };
+
+private:
+    StrategyId strategy;
+    std::vector<Dimension> dimensions;
+
+public:
+    ParamGrid(StrategyId id, std::vector<Dimension> grid_dimensions);
+
+    // Name used on the command line and in result files, e.g. "HOTT-LOTT"
+    static const char* strategyName(StrategyId id);
+    static bool strategyFromName(const std::string& name, StrategyId& id);
+
+    StrategyId strategyId() const { return strategy; }
+
+    // Number of grid values of dimension `d`
+    std::size_t size(int d) const {
+        return dimensions[d].labels.empty() ? dimensions[d].values.size() : dimensions[d].labels.size();
+    }
+
+    // Whether a ParamKey can name every combination: at most MAX_DIMENSIONS dimensions and
+    // MAX_VALUES values per dimension, so no index is narrowed and SL/TP are never dropped.
+    // Otherwise `problem` says which limit the grid breaks.
+    bool fitsParamKey(std::string& problem) const;
+
+    // Value of dimension `d` at the key's index
+    double value(const ParamKey& key, int d) const { return dimensions[d].values[key.index[d]]; }
+
+    // The same text the strategy's XxxParams::getParamString() produces, for CSV export
+    std::string describe(const ParamKey& key) const;
+
+    // Fill in params_str (and strategy_name) of results that do not have it yet
+    void describeAll(std::vector<BacktestResult>& results) const;
+
+    // Hash of the strategy and every dimension's values and labels; grids of the same shape
+    // but with different values differ
+    uint64_t fingerprint() const;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "price_series.h"
+
+// Finds the first bar in a range whose high reaches, or whose low falls to, a price level.
+// Bars are grouped into blocks with per-block extremes, and a sparse table over the blocks
+// skips any run of blocks that cannot contain the level in O(log n), so a query costs at most
+// two partial block scans plus a logarithmic jump instead of one check per bar.
+// Build once per price series; queries are const and safe to share between threads.
+class PriceLevelIndex {
+private:
+    SeriesView highs;
+    SeriesView lows;
+    std::size_t block_count;
+
+    // Level k holds the extreme over the 2^k blocks starting at each block
+    std::vector<std::vector<double>> block_max;
+    std::vector<std::vector<double>> block_min;
+
+public:
+    static const std::size_t BLOCK_SIZE = 64;
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    explicit PriceLevelIndex(const PriceSeries& prices);
+
+    // First i in [from, to] with highs[i] >= level, or npos
+    std::size_t firstHighAtOrAbove(std::size_t from, std::size_t to, double level) const;
+
+    // First i in [from, to] with lows[i] <= level, or npos
+    std::size_t firstLowAtOrBelow(std::size_t from, std::size_t to, double level) const;
+
+    // First i in [from, to] with lows[i] <= low_level or highs[i] >= high_level, or npos:
+    // a stop and a target found in one pass instead of two
+    std::size_t firstOutside(std::size_t from, std::size_t to, double low_level, double high_level) const;
+};
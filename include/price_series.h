@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "hashing.h"
+#include "models.h"
+
+// Non-owning view over a contiguous series of doubles (a price column or a cached indicator).
+// A non-zero id is a stable identity of the contents, used for indicator cache keys. The owner
+// of the values supplies it: price columns and cached series carry theirs, and a view of a
+// vector hashes the contents once, when it is made explicitly, so the vector must not change
+// while the view is in use. Id 0 marks a scratch view that is never used as a cache input.
+class SeriesView {
+private:
+    const double* ptr;
+    std::size_t len;
+    uint64_t series_id;
+
+public:
+    SeriesView() : ptr(nullptr), len(0), series_id(0) {}
+    SeriesView(const double* values, std::size_t count, uint64_t id) : ptr(values), len(count), series_id(id) {}
+    explicit SeriesView(const std::vector<double>& values)
+        : ptr(values.data()), len(values.size()), series_id(seriesContentId(values.data(), values.size())) {}
+
+    const double& operator[](std::size_t i) const { return ptr[i]; }
+    const double* data() const { return ptr; }
+    std::size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const double* begin() const { return ptr; }
+    const double* end() const { return ptr + len; }
+    uint64_t id() const { return series_id; }
+};
+
+// Immutable structure-of-arrays price data shared by all optimizers and backtesters.
+// Every column is 64-byte aligned; the storage is either one owned block or a mapped bar cache.
+class PriceSeries {
+private:
+    std::shared_ptr<const void> storage;
+    const int64_t* timestamp_column;
+    const double* open_column;
+    const double* high_column;
+    const double* low_column;
+    const double* close_column;
+    const double* volume_column;
+    std::size_t bar_count;
+    uint64_t source_checksum;
+    uint64_t column_ids[5];
+    bool time_of_day;
+
+    PriceSeries();
+
+public:
+    static const std::size_t COLUMN_ALIGNMENT = 64;
+
+    // Copy columns into a single aligned block
+    static std::shared_ptr<const PriceSeries> fromColumns(const std::vector<int64_t>& timestamps,
+                                                        const std::vector<double>& opens,
+                                                        const std::vector<double>& highs,
+                                                        const std::vector<double>& lows,
+                                                        const std::vector<double>& closes,
+                                                        const std::vector<double>& volumes,
+                                                        uint64_t checksum = 0,
+                                                        bool has_time_of_day = false);
+
+    // Wrap externally owned columns (e.g. a mapped bar cache); `owner` keeps them alive.
+    // `column_ids` (open/high/low/close/volume) are computed from the data if not given.
+    // `has_time_of_day` makes dates format with their time, as in the source.
+    static std::shared_ptr<const PriceSeries> fromMapped(std::shared_ptr<const void> owner,
+                                                       const int64_t* timestamps,
+                                                       const double* opens,
+                                                       const double* highs,
+                                                       const double* lows,
+                                                       const double* closes,
+                                                       const double* volumes,
+                                                       std::size_t count,
+                                                       uint64_t checksum,
+                                                       const uint64_t* column_ids = nullptr,
+                                                       bool has_time_of_day = false);
+
+    // Identity of a series' data: its timestamps and the content ids of its five value columns
+    static uint64_t columnsChecksum(const int64_t* timestamps, std::size_t count, const uint64_t* column_ids);
+
+    // Map the CSV's bar cache, or parse the CSV (and write the cache when enabled).
+    // Returns nullptr if the file cannot be read.
+    static std::shared_ptr<const PriceSeries> load(const std::string& csv_filename, bool use_bar_cache = true);
+
+    // Parse a CSV (Date,Open,High,Low,Close[,Volume]) straight into columns through a memory
+    // mapping, without building Bar objects. Dates become Unix epoch seconds; a missing volume
+    // column is filled with zeros. Rows whose date is not ISO or a Unix timestamp are skipped as
+    // malformed. `has_time_of_day` reports whether any date carried a time.
+    static bool loadCSVColumns(const std::string& filename,
+                             std::vector<int64_t>& timestamps,
+                             std::vector<double>& opens,
+                             std::vector<double>& highs,
+                             std::vector<double>& lows,
+                             std::vector<double>& closes,
+                             std::vector<double>& volumes,
+                             bool& has_time_of_day);
+
+    // Format an epoch timestamp as "YYYY-MM-DD", or "YYYY-MM-DD HH:MM:SS" with `with_time`
+    static std::string formatTimestamp(int64_t timestamp, bool with_time);
+
+    std::size_t size() const { return bar_count; }
+    bool empty() const { return bar_count == 0; }
+
+    // Column views carry content ids, so indicator caches recognise the same data
+    // across optimizers (and across runs) without rehashing it
+    SeriesView opens() const { return SeriesView(open_column, bar_count, column_ids[0]); }
+    SeriesView highs() const { return SeriesView(high_column, bar_count, column_ids[1]); }
+    SeriesView lows() const { return SeriesView(low_column, bar_count, column_ids[2]); }
+    SeriesView closes() const { return SeriesView(close_column, bar_count, column_ids[3]); }
+    SeriesView volumes() const { return SeriesView(volume_column, bar_count, column_ids[4]); }
+    const int64_t* timestamps() const { return timestamp_column; }
+    int64_t timestamp(std::size_t i) const { return timestamp_column[i]; }
+
+    // Checksum of the source data (columnsChecksum, unless a derived series was given its own)
+    uint64_t checksum() const { return source_checksum; }
+
+    // Whether the source dates had a time of day; if so every date is formatted with one
+    bool hasTimeOfDay() const { return time_of_day; }
+
+    // AoS bar for export; dates are formatted on demand
+    Bar bar(std::size_t i) const;
+    std::string date(std::size_t i) const { return formatTimestamp(timestamp_column[i], time_of_day); }
+};
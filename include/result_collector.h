@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "models.h"
+#include "thread_pool.h"
+
+// Metric results are ranked by when only the top K are kept
+enum class ResultMetric {
+    NetProfit,
+    WinRate,
+    ProfitFactor,
+    ProfitPercent,
+    MaxDrawdown     // Lower is better
+};
+
+// Value of `metric` in a BacktestResult or BacktestMetrics, oriented so that higher is better
+template <typename Result>
+double rankingValue(const Result& result, ResultMetric metric) {
+    switch (metric) {
+        case ResultMetric::NetProfit: return result.net_profit;
+        case ResultMetric::WinRate: return result.win_rate;
+        case ResultMetric::ProfitFactor: return result.profit_factor;
+        case ResultMetric::ProfitPercent: return result.profit_percent;
+        case ResultMetric::MaxDrawdown: return -result.max_drawdown;
+    }
+    return 0.0;
+}
+
+// Collects the results of an optimizer grid without shared locks. Each thread appends to its
+// own cache-line aligned arena; duplicate combinations are caught by a lock-free set of
+// parameter keys instead of a mutex-guarded map of parameter strings. merge() then gathers
+// the arenas, optionally keeping only the best K results by a metric.
+class ResultCollector {
+private:
+    struct alignas(64) Arena {
+        std::thread::id owner;
+        ThreadPool* pool;       // Pool the owner works for, nullptr outside any pool
+        std::vector<BacktestResult> results;
+    };
+
+    // Open-addressing slot. `tag` is 0 while empty, WRITING while its key is being stored and
+    // the key's hash with bit 1 set once it can be compared; tags only filter, keys decide.
+    struct Slot {
+        static constexpr uint64_t WRITING = 1;
+        std::atomic<uint64_t> tag{0};
+        ParamKey key;
+    };
+
+    std::unique_ptr<Slot[]> seen;
+    std::size_t seen_mask;
+    std::size_t seen_limit;
+    std::atomic<std::size_t> seen_count;
+
+    const uint64_t collector_id;
+    std::vector<std::unique_ptr<Arena>> arenas;
+    std::mutex arenas_mutex;    // Taken once per thread, when its arena is created
+
+    Arena& localArena();
+
+public:
+    // `expected_combinations` sizes the duplicate filter. Claiming more distinct keys than
+    // that is a caller bug and aborts instead of letting duplicates through.
+    explicit ResultCollector(std::size_t expected_combinations);
+
+    ResultCollector(const ResultCollector&) = delete;
+    ResultCollector& operator=(const ResultCollector&) = delete;
+
+    // Ranking metric by its column name ("net_profit", "win_rate", "profit_factor",
+    // "profit_percent", "max_drawdown"); unknown names fall back to net profit
+    static ResultMetric metricFromName(const std::string& name);
+
+    // Returns true the first time `key` is seen and false for every later duplicate, so a
+    // duplicate combination can be skipped before it is simulated
+    bool claim(const ParamKey& key);
+
+    // Store a result, identified by its param_key, in the calling thread's arena
+    void add(BacktestResult&& result);
+
+    // Move every result out, without duplicates. With top_k > 0 only the best top_k by
+    // `metric` are kept, best first (ties by key); otherwise results are ordered by key.
+    // Each arena is trimmed on the pool of the thread that filled it (the shared pool for
+    // threads outside any), so NUMA shards trim their own memory. Call after all adds are done.
+    std::vector<BacktestResult> merge(std::size_t top_k = 0, ResultMetric metric = ResultMetric::NetProfit);
+};
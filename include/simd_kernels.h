@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+
+// Instruction sets the element-wise indicator kernels are built for
+enum class SimdLevel : int {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+// Element-wise parts of the indicators. Every kernel writes out[i] for i in [begin, end) and
+// reads inputs at the same index (and, where noted, a fixed distance back). All levels give
+// bit-identical results: they use the same IEEE operations in the same order, only wider.
+struct SimdKernelTable {
+    SimdLevel level;
+
+    // out[i] = |data[i] - data[i - period]|, with begin >= period
+    void (*absChange)(const double* data, std::size_t period, std::size_t begin, std::size_t end, double* out);
+
+    // out[i] = max(high - low, |high - previous close|, |low - previous close|), with begin >= 1
+    void (*trueRange)(const double* highs, const double* lows, const double* closes,
+                      std::size_t begin, std::size_t end, double* out);
+
+    // out[i] = momentum / volatility, or 0 where the volatility is 0
+    void (*efficiencyRatio)(const double* momentum, const double* volatility,
+                            std::size_t begin, std::size_t end, double* out);
+
+    // Stochastic %K: (close - lowest) / (highest - lowest) * 100, or 100 for an empty range
+    void (*stochasticK)(const double* closes, const double* highest, const double* lowest,
+                        std::size_t begin, std::size_t end, double* out);
+
+    // Bollinger bands from running window sums of values shifted by an anchor: `centered` is
+    // basis - anchor, sum_x and sum_xx the window sums of (x - anchor) and its square
+    void (*bollingerBands)(const double* basis, const double* centered, const double* sum_x, const double* sum_xx,
+                           double length, double multiplier, std::size_t begin, std::size_t end,
+                           double* upper, double* lower);
+};
+
+// Picks the widest kernel table this binary was built with and this CPU supports, once, at
+// first use. One build therefore runs on machines with and without AVX2/AVX-512.
+class SimdKernels {
+public:
+    // Table in use; detected on first call unless setLevel() chose one
+    static const SimdKernelTable& active();
+
+    // Best level available on this machine
+    static SimdLevel detect();
+
+    // Table for `level`, or nullptr if it is not built in or not supported by the CPU
+    static const SimdKernelTable* table(SimdLevel level);
+
+    // Force a level, e.g. to compare against the scalar path; false if it is unavailable
+    static bool setLevel(SimdLevel level);
+
+    static const char* levelName(SimdLevel level);
+    static bool levelFromName(const char* name, SimdLevel& level);
+};
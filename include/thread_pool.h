@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops its own tasks at
+// the back and, when it runs dry, steals from the front of the others, so a burst of small
+// tasks spreads over all cores without a central queue. Tasks submitted from outside the pool
+// are dealt round-robin. Tasks must not throw. A pool may be pinned to one NUMA node.
+class ThreadPool {
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    int numa_node;
+    std::atomic<std::size_t> pending;
+    std::atomic<std::size_t> next_queue;
+    std::atomic<bool> stopping;
+    std::mutex sleep_mutex;
+    std::condition_variable work_available;
+
+    bool popTask(std::size_t queue, std::function<void()>& task);
+    bool stealTask(std::size_t thief, std::function<void()>& task);
+    void workerLoop(std::size_t index);
+
+public:
+    // num_threads <= 0 uses the hardware concurrency; with numa_node >= 0 every worker is
+    // bound to that node's CPUs
+    explicit ThreadPool(int num_threads = 0, int numa_node = -1);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // The process-wide pool, created on first use with the size last given to setSharedSize
+    static ThreadPool& shared();
+    static void setSharedSize(int num_threads);
+
+    int size() const { return static_cast<int>(workers.size()); }
+    int node() const { return numa_node; }
+
+    // NUMA node of the pool the calling thread works for, or -1 (not a worker, or unpinned)
+    static int currentNode();
+
+    // Whether the calling thread is one of this pool's workers
+    bool ownsCurrentThread() const;
+
+    // Pool the calling thread works for, or nullptr outside any pool
+    static ThreadPool* current();
+
+    void submit(std::function<void()> task);
+
+    // Run one pending task on the calling thread; returns false if there was none. Lets a
+    // thread that waits for its tasks help with them instead of blocking a worker.
+    bool runPendingTask();
+
+    // Block the calling worker until a task is pending, the pool stops or `ready` holds;
+    // `ready` is re-checked whenever wakeWaiters() is called
+    void waitForTask(const std::function<bool()>& ready);
+    void wakeWaiters();
+};
+
+// A set of tasks that can be waited for together. A worker of the pool that waits runs pool
+// tasks meanwhile and sleeps only while there are none, so groups may be nested inside other
+// tasks without deadlock; any other thread just blocks, keeping the work on the pool's own
+// (possibly pinned) workers. Either is woken by the task that finishes the group.
+class TaskGroup {
+private:
+    ThreadPool& pool;
+    std::atomic<std::size_t> outstanding;
+    std::mutex done_mutex;
+    std::condition_variable done;
+
+public:
+    explicit TaskGroup(ThreadPool& thread_pool = ThreadPool::shared());
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+};
+
+// Call body(begin, end) over [0, count) in chunks of about `grain` items on the pool, and
+// return once all chunks are done
+void parallelFor(std::size_t count, std::size_t grain,
+                 const std::function<void(std::size_t, std::size_t)>& body,
+                 ThreadPool& pool = ThreadPool::shared());
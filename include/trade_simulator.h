@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "models.h"
+#include "backtest_metrics.h"
+#include "price_series.h"
+#include "price_level_index.h"
+
+// Half-open range of bars a simulation covers; the default is the whole series
+struct BarRange {
+    std::size_t begin = 0;
+    std::size_t end = SIZE_MAX;
+};
+
+struct OpenPosition {
+    int entry_index;
+    double entry_price;
+    double side;
+    double stop;
+    double target;
+};
+
+// Where one lane stands once its run has reached `next_bar`: the metrics of the trades closed
+// so far and the positions still open (entry_index in absolute bars), before any "End" close
+struct LaneState {
+    MetricsAccumulator metrics;
+    std::vector<OpenPosition> positions;
+    uint64_t next_bar = 0;
+};
+
+// Runs one direction vector against a whole SL x TP grid. The direction changes are collected
+// once into a signal list, and every (sl, tp) lane only steps from signal to signal: the first
+// stop or target hit in between is found through a PriceLevelIndex rather than by checking
+// each bar, so the cost grows with the number of signals and exits, not with the bar count.
+// Build one simulator per price series and share it; run() is const and thread-safe.
+//
+// Trade rules:
+//  - dir[i] is the desired side at bar i (1 long, -1 short, 0 no opinion). A signal occurs
+//    when dir[i] is non-zero and differs from dir[i - 1].
+//  - On a signal, positions on the other side close at the bar's close ("Signal") and a new
+//    position opens at that close. Without pyramiding a lane holds at most one position, so
+//    a signal in the direction already held is ignored.
+//  - From the bar after entry, a long stops out when low <= entry * (1 - sl%) and takes
+//    profit when high >= entry * (1 + tp%), mirrored for shorts, filling at the level itself.
+//    When both levels lie inside one bar the stop is assumed to fill first.
+//  - Positions still open after the last bar close at its close ("End").
+//  - A BarRange restricts all of this to its bars: each lane starts flat, only signals inside
+//    the range open trades (a signal still needs a change from the bar before the range), and
+//    the range's last bar acts as the last bar of the series.
+//  - Each trade commits the initial capital: profit = capital * side * (exit / entry - 1).
+//  - continueMetrics() picks lanes up from saved LaneStates instead of flat, so a series that
+//    grew only needs its new bars simulated.
+class TradeSimulator {
+private:
+    SeriesView closes;
+    SeriesView highs;
+    SeriesView lows;
+    std::shared_ptr<const PriceLevelIndex> level_index;
+    double initial_capital;
+    bool exclude_sl_from_winrate;
+
+    // Simulate `lane_count` lanes of the grid starting at `first_lane` (sl-major order),
+    // feeding metrics[k] and, when `trades` is not null, trades[k] for each lane k. With a
+    // filter, a lane stops at the first signal where it provably can no longer pass. With
+    // `states`, lane k starts from states[k] and leaves its state there at the end; the series
+    // is then a window of a longer one that starts at absolute bar `first_bar`.
+    void simulate(const std::vector<int>& dir,
+                  const std::vector<double>& sl_percents,
+                  const std::vector<double>& tp_percents,
+                  bool use_sl,
+                  bool use_tp,
+                  bool pyramiding,
+                  std::size_t first_lane,
+                  std::size_t lane_count,
+                  MetricsAccumulator* metrics,
+                  std::vector<Trade>* trades,
+                  const BacktestFilter* filter,
+                  const BarRange& range,
+                  LaneState* states = nullptr,
+                  std::size_t first_bar = 0) const;
+
+    // The lane loop of simulate(), compiled once per SL/TP/pyramiding combination so that
+    // disabled features cost nothing per signal; reads the signal lists simulate() collected
+    template <bool UseSL, bool UseTP, bool Pyramiding>
+    void simulateLanes(std::size_t begin,
+                       std::size_t end,
+                       const std::vector<double>& sl_percents,
+                       const std::vector<double>& tp_percents,
+                       std::size_t first_lane,
+                       std::size_t lane_count,
+                       MetricsAccumulator* metrics,
+                       std::vector<Trade>* trades,
+                       const BacktestFilter* filter,
+                       LaneState* states,
+                       std::size_t first_bar) const;
+
+public:
+    TradeSimulator(const PriceSeries& prices, double capital = 10000.0, bool exclude_sl = false);
+
+    // Bars of the series the simulator runs on
+    std::size_t size() const { return closes.size(); }
+
+    // Metrics of every (sl, tp) pair in sl-major order: metrics[s * tp_percents.size() + t] is
+    // (sl_percents[s], tp_percents[t]). No trades are materialized and scratch buffers are
+    // reused per thread, so once `metrics` has its capacity a run performs no heap allocation.
+    // Combinations that can no longer meet `filter` are abandoned early and come back with
+    // `pruned` set (their other fields are partial); returns how many were pruned.
+    std::size_t runMetrics(const std::vector<int>& dir,
+                           const std::vector<double>& sl_percents,
+                           const std::vector<double>& tp_percents,
+                           bool use_sl,
+                           bool use_tp,
+                           bool pyramiding,
+                           std::vector<BacktestMetrics>& metrics,
+                           const BacktestFilter& filter = BacktestFilter(),
+                           const BarRange& range = BarRange()) const;
+
+    // runMetrics() continued from `states`, one per lane in the order of runMetrics, on a
+    // simulator over a window of the grown series that starts at absolute bar `first_bar`.
+    // Each lane resumes at its state's next_bar, which must lie inside the window, and the
+    // states are advanced to the window's end. Trades still open are closed at the last bar
+    // for the metrics but stay open in the states. Nothing is pruned; returns false (with a
+    // message) if the states do not fit the grid or the window, or the window is empty.
+    bool continueMetrics(const std::vector<int>& dir,
+                         const std::vector<double>& sl_percents,
+                         const std::vector<double>& tp_percents,
+                         bool use_sl,
+                         bool use_tp,
+                         bool pyramiding,
+                         std::vector<LaneState>& states,
+                         std::vector<BacktestMetrics>& metrics,
+                         std::size_t first_bar) const;
+
+    // Full result with its trade list for one (sl, tp) pair, e.g. to export the trades of the
+    // top results after a metrics-only sweep
+    BacktestResult replay(const std::vector<int>& dir,
+                          double sl_percent,
+                          double tp_percent,
+                          bool use_sl,
+                          bool use_tp,
+                          bool pyramiding,
+                          const BarRange& range = BarRange()) const;
+
+    // Full results with trade lists for the whole grid, in the order of runMetrics.
+    // params_str and strategy_name are left for the caller to fill in.
+    std::vector<BacktestResult> run(const std::vector<int>& dir,
+                                    const std::vector<double>& sl_percents,
+                                    const std::vector<double>& tp_percents,
+                                    bool use_sl,
+                                    bool use_tp,
+                                    bool pyramiding) const;
+};
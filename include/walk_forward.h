@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "backtest_metrics.h"
+#include "param_key.h"
+#include "result_collector.h"
+#include "thread_pool.h"
+#include "trade_simulator.h"
+
+// Rolling walk-forward layout: in-sample windows of `in_sample_bars` followed by
+// `out_of_sample_bars`, advanced by `step_bars` (the out-of-sample length when 0)
+struct WalkForwardConfig {
+    std::size_t in_sample_bars = 0;
+    std::size_t out_of_sample_bars = 0;
+    std::size_t step_bars = 0;
+    std::size_t top_k = 1;                          // Winners carried to each out-of-sample slice
+    ResultMetric metric = ResultMetric::NetProfit;  // How in-sample results are ranked
+    BacktestFilter filter;                          // In-sample results must pass it to be picked
+};
+
+// The variant's key extended by the SL and TP grid indices of `lane` (sl-major over
+// `tp_count` TP values) and the SL/TP/pyramiding switches
+ParamKey laneKey(ParamKey key, std::size_t lane, std::size_t tp_count, bool use_sl, bool use_tp, bool pyramiding);
+
+// One in-sample winner and how it did on the slice that followed
+struct WalkForwardPick {
+    ParamKey key;
+    BacktestMetrics in_sample;
+    BacktestMetrics out_of_sample;
+};
+
+struct WalkForwardWindow {
+    BarRange in_sample;
+    BarRange out_of_sample;
+    std::vector<WalkForwardPick> picks;     // Best first
+};
+
+// Walk-forward optimization over a grid of signal variants (the strategy parameters) times
+// the SL x TP grid. Indicators are causal, so the direction vector of a variant is computed
+// once over the full history and every window only simulates its own bar range of it; one set
+// of indicator series serves all windows, and the simulation cost per window grows with the
+// signals inside it. The in-sample grid of every window is searched in one pass per variant.
+class WalkForwardEngine {
+public:
+    // Full-length direction vector of one variant (see TradeSimulator for its meaning);
+    // returning false skips the variant
+    typedef std::function<bool(std::size_t variant, std::vector<int>& dir)> SignalSource;
+
+    // Key of a variant's own parameters; the engine appends the SL and TP indices
+    typedef std::function<ParamKey(std::size_t variant)> VariantKey;
+
+private:
+    const TradeSimulator& simulator;
+    std::vector<double> sl_percents;
+    std::vector<double> tp_percents;
+    bool use_sl;
+    bool use_tp;
+    bool pyramiding;
+
+public:
+    WalkForwardEngine(const TradeSimulator& trade_simulator,
+                      const std::vector<double>& sl_pcts,
+                      const std::vector<double>& tp_pcts,
+                      bool enable_sl,
+                      bool enable_tp,
+                      bool enable_pyramiding);
+
+    // Window layout for a series of `bars` bars; the last window ends at or before the end
+    static std::vector<WalkForwardWindow> layout(std::size_t bars, const WalkForwardConfig& config);
+
+    // Optimize every in-sample window and evaluate its winners out of sample. Variants run as
+    // tasks on `pool`; `signals` may be called concurrently for different variants.
+    std::vector<WalkForwardWindow> run(std::size_t bars,
+                                       const WalkForwardConfig& config,
+                                       std::size_t variant_count,
+                                       const VariantKey& variant_key,
+                                       const SignalSource& signals,
+                                       ThreadPool& pool = ThreadPool::shared()) const;
+};
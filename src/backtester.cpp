@@ -0,0 +1,456 @@
+#include "backtester.h"
+#include "backtest_metrics.h"
+
+// 1 above the upper line, -1 below the lower one, 0 in between
+static int crossSide(double value, double upper, double lower) {
+    return value > upper ? 1 : (value < lower ? -1 : 0);
+}
+
+StrategyBacktester::StrategyBacktester(std::shared_ptr<const PriceSeries> price_series,
+                                       std::shared_ptr<IndicatorCache> indicator_cache,
+                                       double capital,
+                                       bool exclude_sl)
+    : prices(std::move(price_series)), closes(prices->closes()), highs(prices->highs()), lows(prices->lows()),
+      opens(prices->opens()), initial_capital(capital), exclude_sl_from_winrate(exclude_sl),
+      cache(std::move(indicator_cache)) {}
+
+std::vector<Trade> StrategyBacktester::processTrades(const std::vector<int>& dir, bool use_sl, bool use_tp,
+                                                     double sl_percent, double tp_percent, bool pyramiding) {
+    struct Position {
+        int entry_index;
+        double entry_price;
+        double side;
+        double stop;
+        double target;
+    };
+    std::vector<Trade> trades;
+    std::vector<Position> positions;
+    const std::size_t n = std::min(dir.size(), closes.size());
+
+    auto close = [&](const Position& position, std::size_t i, double price, const char* reason) {
+        Trade trade;
+        trade.entry_index = position.entry_index;
+        trade.exit_index = static_cast<int>(i);
+        trade.entry_price = position.entry_price;
+        trade.exit_price = price;
+        trade.profit = initial_capital * position.side * (price / position.entry_price - 1.0);
+        trade.is_long = position.side > 0;
+        trade.exit_reason = reason;
+        trades.push_back(trade);
+    };
+
+    for (std::size_t i = 0; i < n; ++i) {
+        // Stops and targets of positions opened on earlier bars, the stop first
+        std::size_t kept = 0;
+        for (std::size_t p = 0; p < positions.size(); ++p) {
+            const Position& position = positions[p];
+            bool long_side = position.side > 0;
+            if (use_sl && (long_side ? lows[i] <= position.stop : highs[i] >= position.stop)) {
+                close(position, i, position.stop, "SL");
+            } else if (use_tp && (long_side ? highs[i] >= position.target : lows[i] <= position.target)) {
+                close(position, i, position.target, "TP");
+            } else {
+                positions[kept++] = position;
+            }
+        }
+        positions.resize(kept);
+
+        if (dir[i] == 0 || (i > 0 && dir[i] == dir[i - 1])) {
+            continue;
+        }
+        double side = dir[i] > 0 ? 1.0 : -1.0;
+        kept = 0;
+        for (std::size_t p = 0; p < positions.size(); ++p) {
+            if (positions[p].side == -side) {
+                close(positions[p], i, closes[i], "Signal");
+            } else {
+                positions[kept++] = positions[p];
+            }
+        }
+        positions.resize(kept);
+
+        if (pyramiding || positions.empty()) {
+            Position position = {static_cast<int>(i), closes[i], side,
+                                 closes[i] * (1.0 - side * sl_percent / 100.0),
+                                 closes[i] * (1.0 + side * tp_percent / 100.0)};
+            positions.push_back(position);
+        }
+    }
+
+    for (const auto& position : positions) {
+        close(position, n - 1, closes[n - 1], "End");
+    }
+    return trades;
+}
+
+BacktestResult StrategyBacktester::calculateResults(const std::vector<Trade>& trades, const std::string& params_str,
+                                                    const std::string& strategy_name) {
+    MetricsAccumulator accumulator(initial_capital);
+    for (const auto& trade : trades) {
+        accumulator.addTrade(trade.profit, trade.exit_reason == "SL");
+    }
+
+    BacktestResult result;
+    accumulator.metrics(exclude_sl_from_winrate).applyTo(result);
+    result.trades = trades;
+    result.params_str = params_str;
+    result.strategy_name = strategy_name;
+    return result;
+}
+
+BacktestResult StrategyBacktester::backtest(const std::vector<int>& dir, const StrategyParams& params) {
+    std::vector<Trade> trades = processTrades(dir, params.use_sl, params.use_tp, params.sl_percent,
+                                              params.tp_percent, params.pyramiding);
+    return calculateResults(trades, params.getParamString(), params.strategy_name);
+}
+
+BacktestResult StrategyBacktester::runSignals(const std::vector<int>& dir, bool use_sl, bool use_tp,
+                                              double sl_percent, double tp_percent, bool pyramiding) {
+    return calculateResults(processTrades(dir, use_sl, use_tp, sl_percent, tp_percent, pyramiding), "", "");
+}
+
+std::vector<Bar> StrategyBacktester::loadCSV(const std::string& filename) {
+    std::vector<Bar> bars;
+    auto series = PriceSeries::load(filename, false);
+    if (series) {
+        bars.reserve(series->size());
+        for (std::size_t i = 0; i < series->size(); ++i) {
+            bars.push_back(series->bar(i));
+        }
+    }
+    return bars;
+}
+
+void StrategyBacktester::preprocessPriceData(const std::vector<Bar>& bars,
+                                             std::vector<double>& closes,
+                                             std::vector<double>& highs,
+                                             std::vector<double>& lows,
+                                             std::vector<double>& opens) {
+    closes.clear();
+    highs.clear();
+    lows.clear();
+    opens.clear();
+    for (const auto& bar : bars) {
+        closes.push_back(bar.close);
+        highs.push_back(bar.high);
+        lows.push_back(bar.low);
+        opens.push_back(bar.open);
+    }
+}
+
+OttBacktester::OttBacktester(std::shared_ptr<const PriceSeries> price_series,
+                             const OttParams& strategy_params,
+                             std::shared_ptr<IndicatorCache> indicator_cache,
+                             double capital,
+                             bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult OttBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+TottBacktester::TottBacktester(std::shared_ptr<const PriceSeries> price_series,
+                               const TottParams& strategy_params,
+                               std::shared_ptr<IndicatorCache> indicator_cache,
+                               double capital,
+                               bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult TottBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+OttChannelBacktester::OttChannelBacktester(std::shared_ptr<const PriceSeries> price_series,
+                                           const OttChannelParams& strategy_params,
+                                           std::shared_ptr<IndicatorCache> indicator_cache,
+                                           double capital,
+                                           bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult OttChannelBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+RisottoBacktester::RisottoBacktester(std::shared_ptr<const PriceSeries> price_series,
+                                     const RisottoParams& strategy_params,
+                                     std::shared_ptr<IndicatorCache> indicator_cache,
+                                     double capital,
+                                     bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult RisottoBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+SottBacktester::SottBacktester(std::shared_ptr<const PriceSeries> price_series,
+                               const SottParams& strategy_params,
+                               std::shared_ptr<IndicatorCache> indicator_cache,
+                               double capital,
+                               bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult SottBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+HottLottBacktester::HottLottBacktester(std::shared_ptr<const PriceSeries> price_series,
+                                       const HottLottParams& strategy_params,
+                                       std::shared_ptr<IndicatorCache> indicator_cache,
+                                       double capital,
+                                       bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult HottLottBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+RottBacktester::RottBacktester(std::shared_ptr<const PriceSeries> price_series,
+                               const RottParams& strategy_params,
+                               std::shared_ptr<IndicatorCache> indicator_cache,
+                               double capital,
+                               bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult RottBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+FtBacktester::FtBacktester(std::shared_ptr<const PriceSeries> price_series,
+                           const FtParams& strategy_params,
+                           std::shared_ptr<IndicatorCache> indicator_cache,
+                           double capital,
+                           bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult FtBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+RtrBacktester::RtrBacktester(std::shared_ptr<const PriceSeries> price_series,
+                             const RtrParams& strategy_params,
+                             std::shared_ptr<IndicatorCache> indicator_cache,
+                             double capital,
+                             bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult RtrBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+MottBacktester::MottBacktester(std::shared_ptr<const PriceSeries> price_series,
+                               const MottParams& strategy_params,
+                               std::shared_ptr<IndicatorCache> indicator_cache,
+                               double capital,
+                               bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult MottBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+BootsBacktester::BootsBacktester(std::shared_ptr<const PriceSeries> price_series,
+                                 const BootsParams& strategy_params,
+                                 std::shared_ptr<IndicatorCache> indicator_cache,
+                                 double capital,
+                                 bool exclude_sl)
+    : StrategyBacktester(std::move(price_series), std::move(indicator_cache), capital, exclude_sl),
+      params(strategy_params) {}
+
+BacktestResult BootsBacktester::runBacktest() {
+    std::vector<int> dir;
+    signals(*cache, *prices, params, dir);
+    return backtest(dir, params);
+}
+
+// OTT: the VAR support line against its OTT
+void OttBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                            const OttParams& strategy_params, std::vector<int>& dir) {
+    CachedSeries var = indicator_cache.getVAR(price_series.closes(), strategy_params.support_length);
+    CachedSeries ott = indicator_cache.getOTT(var, strategy_params.ott_multiplier);
+    dir.resize(var.size());
+    for (std::size_t i = 0; i < var.size(); ++i) {
+        dir[i] = crossSide(var[i], ott[i], ott[i]);
+    }
+}
+
+// TOTT: the support line has to leave a band around the OTT
+void TottBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                             const TottParams& strategy_params, std::vector<int>& dir) {
+    CachedSeries var = indicator_cache.getVAR(price_series.closes(), strategy_params.support_length);
+    CachedSeries ott = indicator_cache.getOTT(var, strategy_params.ott_multiplier);
+    const double band = strategy_params.band_multiplier;
+    dir.resize(var.size());
+    for (std::size_t i = 0; i < var.size(); ++i) {
+        dir[i] = crossSide(var[i], ott[i] * (1.0 + band), ott[i] * (1.0 - band));
+    }
+}
+
+// OTT channel: the close breaking out of a channel around the OTT, its widths in percent of
+// the OTT line (halved for the half channel)
+void OttChannelBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                                   const OttChannelParams& strategy_params, std::vector<int>& dir) {
+    SeriesView closes = price_series.closes();
+    CachedSeries var = indicator_cache.getVAR(closes, strategy_params.ma_length);
+    CachedSeries ott = indicator_cache.getOTT(var, strategy_params.ott_multiplier);
+    const double scale = strategy_params.channel_type == "Full Channel" ? 1.0 : 0.5;
+    const double upper = scale * strategy_params.upper_multiplier / 100.0;
+    const double lower = scale * strategy_params.lower_multiplier / 100.0;
+    dir.resize(var.size());
+    for (std::size_t i = 0; i < var.size(); ++i) {
+        dir[i] = crossSide(closes[i], ott[i] * (1.0 + upper), ott[i] * (1.0 - lower));
+    }
+}
+
+// RISOTTO: OTT of the VAR-smoothed RSI
+void RisottoBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                                const RisottoParams& strategy_params, std::vector<int>& dir) {
+    CachedSeries rsi = indicator_cache.getRSI(price_series.closes(), strategy_params.rsi_length);
+    CachedSeries var = indicator_cache.getVAR(rsi, strategy_params.support_length);
+    CachedSeries ott = indicator_cache.getOTT(var, strategy_params.ott_multiplier);
+    dir.resize(var.size());
+    for (std::size_t i = 0; i < var.size(); ++i) {
+        dir[i] = crossSide(var[i], ott[i], ott[i]);
+    }
+}
+
+// SOTT: OTT of the VAR-smoothed stochastic %K
+void SottBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                             const SottParams& strategy_params, std::vector<int>& dir) {
+    CachedSeries stoch = indicator_cache.getStochastic(price_series.closes(), price_series.highs(),
+                                                       price_series.lows(), strategy_params.stoch_k_length);
+    CachedSeries var = indicator_cache.getVAR(stoch, strategy_params.stoch_d_length);
+    CachedSeries ott = indicator_cache.getOTT(var, strategy_params.ott_multiplier);
+    dir.resize(var.size());
+    for (std::size_t i = 0; i < var.size(); ++i) {
+        dir[i] = crossSide(var[i], ott[i], ott[i]);
+    }
+}
+
+// HOTT-LOTT: the high above the OTT of the highest highs goes long, the low below the OTT of
+// the lowest lows goes short; a bar that does both has no opinion
+void HottLottBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                                 const HottLottParams& strategy_params, std::vector<int>& dir) {
+    SeriesView highs = price_series.highs();
+    SeriesView lows = price_series.lows();
+    CachedSeries hott = indicator_cache.getOTT(indicator_cache.getHighest(highs, strategy_params.hl_length),
+                                               strategy_params.ott_multiplier);
+    CachedSeries lott = indicator_cache.getOTT(indicator_cache.getLowest(lows, strategy_params.hl_length),
+                                               strategy_params.ott_multiplier);
+    const std::size_t n = hott.size();
+    const int needed = strategy_params.use_sum ? std::max(strategy_params.sum_n_bars, 1) : 1;
+    int long_run = 0;
+    int short_run = 0;
+    dir.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        long_run = highs[i] > hott[i] ? long_run + 1 : 0;
+        short_run = lows[i] < lott[i] ? short_run + 1 : 0;
+        bool go_long = long_run >= needed;
+        bool go_short = short_run >= needed;
+        dir[i] = go_long == go_short ? 0 : (go_long ? 1 : -1);
+    }
+}
+
+// ROTT: the close against the OTT of its VAR
+void RottBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                             const RottParams& strategy_params, std::vector<int>& dir) {
+    SeriesView closes = price_series.closes();
+    CachedSeries var = indicator_cache.getVAR(closes, strategy_params.support_length);
+    CachedSeries ott = indicator_cache.getOTT(var, strategy_params.ott_multiplier);
+    dir.resize(var.size());
+    for (std::size_t i = 0; i < var.size(); ++i) {
+        dir[i] = crossSide(closes[i], ott[i], ott[i]);
+    }
+}
+
+// FT: the support line has to be on the same side of both the major and the minor OTT
+void FtBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                           const FtParams& strategy_params, std::vector<int>& dir) {
+    CachedSeries var = indicator_cache.getVAR(price_series.closes(), strategy_params.support_length);
+    CachedSeries major = indicator_cache.getOTT(var, strategy_params.major_multiplier);
+    CachedSeries minor = indicator_cache.getOTT(var, strategy_params.minor_multiplier);
+    dir.resize(var.size());
+    for (std::size_t i = 0; i < var.size(); ++i) {
+        dir[i] = crossSide(var[i], std::max(major[i], minor[i]), std::min(major[i], minor[i]));
+    }
+}
+
+// RTR: the close leaving a band of one ATR around its VAR
+void RtrBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                            const RtrParams& strategy_params, std::vector<int>& dir) {
+    SeriesView closes = price_series.closes();
+    CachedSeries var = indicator_cache.getVAR(closes, strategy_params.ma_length);
+    CachedSeries atr = indicator_cache.getATR(price_series.highs(), price_series.lows(), closes,
+                                              strategy_params.atr_length);
+    dir.resize(var.size());
+    for (std::size_t i = 0; i < var.size(); ++i) {
+        dir[i] = crossSide(closes[i], var[i] + atr[i], var[i] - atr[i]);
+    }
+}
+
+// MOTT: the OTT signal, taken only while the close is clear of the bottom (long) or top
+// (short) `reference` percent of the recent high-low range
+void MottBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                             const MottParams& strategy_params, std::vector<int>& dir) {
+    SeriesView closes = price_series.closes();
+    CachedSeries var = indicator_cache.getVAR(closes, strategy_params.support_length);
+    CachedSeries ott = indicator_cache.getOTT(var, strategy_params.ott_multiplier);
+    CachedSeries highest = indicator_cache.getHighest(price_series.highs(), strategy_params.hl_length);
+    CachedSeries lowest = indicator_cache.getLowest(price_series.lows(), strategy_params.hl_length);
+    const double reference = strategy_params.reference / 100.0;
+    dir.resize(var.size());
+    for (std::size_t i = 0; i < var.size(); ++i) {
+        double margin = (highest[i] - lowest[i]) * reference;
+        int side = crossSide(var[i], ott[i], ott[i]);
+        if ((side > 0 && closes[i] < lowest[i] + margin) || (side < 0 && closes[i] > highest[i] - margin)) {
+            side = 0;
+        }
+        dir[i] = side;
+    }
+}
+
+// BOOTS: the OTT signal, taken only while the close is still inside the Bollinger bands
+void BootsBacktester::signals(IndicatorCache& indicator_cache, const PriceSeries& price_series,
+                              const BootsParams& strategy_params, std::vector<int>& dir) {
+    SeriesView closes = price_series.closes();
+    CachedSeries var = indicator_cache.getVAR(closes, strategy_params.support_length);
+    CachedSeries ott = indicator_cache.getOTT(var, strategy_params.ott_multiplier);
+    BollingerBands bands = indicator_cache.getBollingerBands(closes, strategy_params.bb_length, BB_MULTIPLIER);
+    dir.resize(var.size());
+    for (std::size_t i = 0; i < var.size(); ++i) {
+        int side = crossSide(var[i], ott[i], ott[i]);
+        if ((side > 0 && closes[i] > bands.upper[i]) || (side < 0 && closes[i] < bands.lower[i])) {
+            side = 0;
+        }
+        dir[i] = side;
+    }
+}
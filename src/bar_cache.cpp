@@ -0,0 +1,140 @@
+#include "bar_cache.h"
+#include "hashing.h"
+#include "mapped_file.h"
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+static const char BAR_CACHE_MAGIC[8] = {'T', 'S', 'O', 'B', 'A', 'R', 'S', '\0'};
+static const uint32_t BAR_CACHE_BYTE_ORDER = 0x01020304;
+static const uint64_t BAR_CACHE_ALIGNMENT = 64;
+
+static uint64_t alignOffset(uint64_t offset) {
+    return (offset + BAR_CACHE_ALIGNMENT - 1) / BAR_CACHE_ALIGNMENT * BAR_CACHE_ALIGNMENT;
+}
+
+bool BarCache::stampSource(const std::string& csv_filename, BarSourceStamp& stamp) {
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(csv_filename, ec);
+    if (ec) {
+        return false;
+    }
+    auto write_time = std::filesystem::last_write_time(csv_filename, ec);
+    if (ec) {
+        return false;
+    }
+    stamp.size = static_cast<uint64_t>(file_size);
+    stamp.mtime = static_cast<int64_t>(write_time.time_since_epoch().count());
+    return true;
+}
+
+std::string BarCache::cachePath(const std::string& csv_filename) {
+    return csv_filename + ".bars";
+}
+
+std::shared_ptr<const PriceSeries> BarCache::map(const std::string& csv_filename) {
+    BarSourceStamp source;
+    if (!stampSource(csv_filename, source)) {
+        return nullptr;
+    }
+
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(cachePath(csv_filename)) || file->size() < sizeof(BarCacheHeader)) {
+        return nullptr;
+    }
+
+    BarCacheHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, BAR_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != FORMAT_VERSION ||
+        header.byte_order != BAR_CACHE_BYTE_ORDER) {
+        return nullptr;
+    }
+
+    // A stale cache is silently rebuilt. Staleness is judged by size and mtime only, since
+    // anything more would mean reading the whole CSV.
+    if (header.source_size != source.size || header.source_mtime != source.mtime) {
+        return nullptr;
+    }
+
+    uint64_t column_bytes = header.bar_count * sizeof(double);
+    for (uint64_t offset : header.column_offsets) {
+        if (offset % BAR_CACHE_ALIGNMENT != 0 || offset + column_bytes > file->size()) {
+            std::cerr << "Warning: ignoring corrupt bar cache " << cachePath(csv_filename) << std::endl;
+            return nullptr;
+        }
+    }
+
+    // The columns are used in place; the mapping lives as long as the series
+    const char* base = file->data();
+    return PriceSeries::fromMapped(
+        file,
+        reinterpret_cast<const int64_t*>(base + header.column_offsets[0]),
+        reinterpret_cast<const double*>(base + header.column_offsets[1]),
+        reinterpret_cast<const double*>(base + header.column_offsets[2]),
+        reinterpret_cast<const double*>(base + header.column_offsets[3]),
+        reinterpret_cast<const double*>(base + header.column_offsets[4]),
+        reinterpret_cast<const double*>(base + header.column_offsets[5]),
+        static_cast<std::size_t>(header.bar_count),
+        header.source_checksum,
+        header.column_ids,
+        (header.flags & BAR_CACHE_TIME_OF_DAY) != 0);
+}
+
+bool BarCache::save(const std::string& csv_filename,
+                    const BarSourceStamp& source,
+                    const std::vector<int64_t>& timestamps,
+                    const std::vector<double>& opens,
+                    const std::vector<double>& highs,
+                    const std::vector<double>& lows,
+                    const std::vector<double>& closes,
+                    const std::vector<double>& volumes,
+                    bool has_time_of_day) {
+    // A CSV written to while it was parsed may have columns from either version
+    BarSourceStamp current;
+    if (!stampSource(csv_filename, current) || !(current == source)) {
+        return false;
+    }
+
+    BarCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, BAR_CACHE_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.byte_order = BAR_CACHE_BYTE_ORDER;
+    header.bar_count = closes.size();
+    header.flags = has_time_of_day ? BAR_CACHE_TIME_OF_DAY : 0;
+    header.source_size = source.size;
+    header.source_mtime = source.mtime;
+
+    // Column identities are hashed once here instead of on every load
+    const std::vector<double>* value_columns[5] = {&opens, &highs, &lows, &closes, &volumes};
+    for (int c = 0; c < 5; ++c) {
+        header.column_ids[c] = seriesContentId(value_columns[c]->data(), value_columns[c]->size());
+    }
+    header.source_checksum = PriceSeries::columnsChecksum(timestamps.data(), timestamps.size(), header.column_ids);
+
+    uint64_t offset = alignOffset(sizeof(header));
+    for (int c = 0; c < 6; ++c) {
+        header.column_offsets[c] = offset;
+        offset = alignOffset(offset + header.bar_count * sizeof(double));
+    }
+
+    return writeFileAtomically(cachePath(csv_filename), [&](std::ostream& out) {
+        const char padding[BAR_CACHE_ALIGNMENT] = {};
+        uint64_t written = 0;
+        auto writeAt = [&](uint64_t target, const void* data, uint64_t size) {
+            out.write(padding, static_cast<std::streamsize>(target - written));
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            written = target + size;
+        };
+
+        uint64_t column_bytes = header.bar_count * sizeof(double);
+        writeAt(0, &header, sizeof(header));
+        writeAt(header.column_offsets[0], timestamps.data(), column_bytes);
+        writeAt(header.column_offsets[1], opens.data(), column_bytes);
+        writeAt(header.column_offsets[2], highs.data(), column_bytes);
+        writeAt(header.column_offsets[3], lows.data(), column_bytes);
+        writeAt(header.column_offsets[4], closes.data(), column_bytes);
+        writeAt(header.column_offsets[5], volumes.data(), column_bytes);
+    });
+}
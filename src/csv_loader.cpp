@@ -0,0 +1,310 @@
+#include "price_series.h"
+#include "mapped_file.h"
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+
+// Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's days_from_civil)
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// Inverse of daysFromCivil
+static void civilFromDays(int64_t z, int64_t& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+// Parse exactly `count` digits starting at p
+static bool parseDigits(const char* p, const char* end, int count, unsigned& value) {
+    if (end - p < count) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < count; ++i) {
+        unsigned digit = static_cast<unsigned>(p[i] - '0');
+        if (digit > 9) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+// Parse a plain decimal ("-123.456") with an exact fast path: up to 19 significant digits and
+// at most 22 fractional digits convert with a single correctly rounded division. Anything else
+// (exponents, long mantissas, inf/nan) goes through std::from_chars.
+static bool parseDouble(const char* begin, const char* end, double& value) {
+    static const double powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* p = begin;
+    bool negative = p < end && *p == '-';
+    if (negative || (p < end && *p == '+')) {
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int fraction_digits = 0;
+    const char* digits_begin = p;
+
+    while (p < end && static_cast<unsigned>(*p - '0') <= 9) {
+        mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+        ++digits;
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && static_cast<unsigned>(*p - '0') <= 9) {
+            mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+            ++digits;
+            ++fraction_digits;
+            ++p;
+        }
+    }
+
+    if (p == end && digits > 0 && digits <= 19 && fraction_digits <= 22 &&
+        mantissa <= (uint64_t(1) << 53)) {
+        double result = static_cast<double>(mantissa) / powers_of_ten[fraction_digits];
+        value = negative ? -result : result;
+        return true;
+    }
+
+    if (digits_begin == end) {
+        return false;
+    }
+    auto parsed = std::from_chars(begin + (begin < end && *begin == '+'), end, value);
+    return parsed.ec == std::errc() && parsed.ptr == end;
+}
+
+// Strip one pair of surrounding double quotes; a lone or unmatched quote is left in place
+static void unquote(const char*& begin, const char*& end) {
+    if (end - begin >= 2 && *begin == '"' && end[-1] == '"') {
+        ++begin;
+        --end;
+    }
+}
+
+// Parse "YYYY-MM-DD", "YYYY-MM-DD HH:MM[:SS]" (also 'T' separated or '/' dates) or a raw
+// Unix timestamp in seconds/milliseconds into epoch seconds. The whole field must match;
+// `has_time` tells whether it carried a time of day.
+static bool parseTimestamp(const char* begin, const char* end, int64_t& timestamp, bool& has_time) {
+    unquote(begin, end);
+
+    unsigned year, month, day;
+    if (parseDigits(begin, end, 4, year) && end - begin >= 10 &&
+        (begin[4] == '-' || begin[4] == '/') && begin[7] == begin[4] &&
+        parseDigits(begin + 5, end, 2, month) && parseDigits(begin + 8, end, 2, day)) {
+        if (month < 1 || month > 12 || day < 1 || day > 31) {
+            return false;
+        }
+        int64_t seconds = daysFromCivil(year, month, day) * 86400;
+
+        const char* p = begin + 10;
+        has_time = p < end;
+        if (has_time) {
+            unsigned hour, minute, second = 0;
+            if (!((*p == ' ' || *p == 'T') && parseDigits(p + 1, end, 2, hour) && end - p >= 6 &&
+                  p[3] == ':' && parseDigits(p + 4, end, 2, minute))) {
+                return false;
+            }
+            p += 6;
+            if (p < end) {
+                if (!(*p == ':' && parseDigits(p + 1, end, 2, second))) {
+                    return false;
+                }
+                p += 3;
+            }
+            if (p != end || hour > 23 || minute > 59 || second > 60) {
+                return false;
+            }
+            seconds += hour * 3600 + minute * 60 + second;
+        }
+
+        timestamp = seconds;
+        return true;
+    }
+
+    int64_t raw = 0;
+    auto parsed = std::from_chars(begin, end, raw);
+    if (parsed.ec != std::errc() || parsed.ptr == begin || parsed.ptr != end) {
+        return false;
+    }
+    // Anything past year 5138 in seconds is really a millisecond timestamp
+    timestamp = raw >= 100000000000LL ? raw / 1000 : raw;
+    has_time = true;
+    return true;
+}
+
+std::string PriceSeries::formatTimestamp(int64_t timestamp, bool with_time) {
+    int64_t days = timestamp / 86400;
+    int64_t seconds = timestamp % 86400;
+    if (seconds < 0) {
+        seconds += 86400;
+        --days;
+    }
+
+    int64_t year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+
+    char buffer[48];
+    if (!with_time) {
+        std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u",
+                      static_cast<long long>(year), month, day);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u %02u:%02u:%02u",
+                      static_cast<long long>(year), month, day,
+                      static_cast<unsigned>(seconds / 3600) % 24u, static_cast<unsigned>(seconds / 60) % 60u,
+                      static_cast<unsigned>(seconds) % 60u);
+    }
+    return buffer;
+}
+
+bool PriceSeries::loadCSVColumns(const std::string& filename,
+                                 std::vector<int64_t>& timestamps,
+                                 std::vector<double>& opens,
+                                 std::vector<double>& highs,
+                                 std::vector<double>& lows,
+                                 std::vector<double>& closes,
+                                 std::vector<double>& volumes,
+                                 bool& has_time_of_day) {
+    auto start_time = std::chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return false;
+    }
+
+    const char* p = file.data();
+    const char* end = p + file.size();
+
+    // Reserve from the line length of a prefix instead of counting every line, with an eighth
+    // to spare for shorter lines later on; should that still fall short, the columns grow
+    // geometrically like any vector
+    const std::size_t sample_bytes = std::min<std::size_t>(file.size(), 64 * 1024);
+    const std::size_t sample_lines = static_cast<std::size_t>(std::count(p, p + sample_bytes, '\n')) + 1;
+    std::size_t estimated_rows = sample_bytes == 0 ? 0 :
+        static_cast<std::size_t>(static_cast<double>(file.size()) / sample_bytes * sample_lines);
+    estimated_rows += estimated_rows / 8;
+
+    timestamps.clear();
+    opens.clear();
+    highs.clear();
+    lows.clear();
+    closes.clear();
+    volumes.clear();
+    timestamps.reserve(estimated_rows);
+    opens.reserve(estimated_rows);
+    highs.reserve(estimated_rows);
+    lows.reserve(estimated_rows);
+    closes.reserve(estimated_rows);
+    volumes.reserve(estimated_rows);
+
+    std::size_t skipped_rows = 0;
+    std::size_t bad_dates = 0;
+    bool first_line = true;
+    has_time_of_day = false;
+
+    while (p < end) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (line_end == nullptr) {
+            line_end = end;
+        }
+        const char* line = p;
+        p = line_end + 1;
+
+        const char* content_end = line_end;
+        if (content_end > line && content_end[-1] == '\r') {
+            --content_end;
+        }
+        if (content_end == line) {
+            continue;
+        }
+
+        // Fields: Date,Open,High,Low,Close[,Volume], anything after the volume is ignored
+        const char* field = line;
+        const char* field_end = static_cast<const char*>(std::memchr(field, ',', content_end - field));
+        int64_t timestamp;
+        bool has_time = false;
+        double values[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+        bool date_valid = field_end != nullptr && parseTimestamp(field, field_end, timestamp, has_time);
+        bool valid = date_valid;
+
+        for (int f = 0; valid && f < 5; ++f) {
+            field = field_end + 1;
+            if (field > content_end) {
+                // Only the volume column is optional
+                valid = f == 4;
+                break;
+            }
+            field_end = static_cast<const char*>(std::memchr(field, ',', content_end - field));
+            if (field_end == nullptr) {
+                field_end = content_end;
+            }
+
+            const char* value_begin = field;
+            const char* value_end = field_end;
+            unquote(value_begin, value_end);
+            valid = parseDouble(value_begin, value_end, values[f]);
+        }
+
+        if (!valid) {
+            // The header row is expected; anything else malformed is counted
+            if (!first_line) {
+                ++skipped_rows;
+                bad_dates += !date_valid;
+            }
+            first_line = false;
+            continue;
+        }
+        first_line = false;
+        has_time_of_day = has_time_of_day || has_time;
+
+        timestamps.push_back(timestamp);
+        opens.push_back(values[0]);
+        highs.push_back(values[1]);
+        lows.push_back(values[2]);
+        closes.push_back(values[3]);
+        volumes.push_back(values[4]);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    double megabytes = file.size() / (1024.0 * 1024.0);
+
+    std::cout << "Parsed " << closes.size() << " rows (" << megabytes << " MB) in "
+              << seconds * 1000.0 << " ms, " << (seconds > 0 ? megabytes / seconds : 0.0)
+              << " MB/s" << std::endl;
+    if (skipped_rows > 0) {
+        std::cerr << "Warning: skipped " << skipped_rows << " malformed rows in " << filename << std::endl;
+    }
+    if (bad_dates > 0) {
+        std::cerr << "Warning: " << bad_dates << " rows had an unrecognised date; expected "
+                  << "YYYY-MM-DD[ HH:MM[:SS]] or a Unix timestamp" << std::endl;
+    }
+    if (closes.empty() && bad_dates > 0) {
+        std::cerr << "Error: no row of " << filename << " has a recognised date" << std::endl;
+        return false;
+    }
+
+    return true;
+}
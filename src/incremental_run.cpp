@@ -0,0 +1,277 @@
+#include "incremental_run.h"
+#include "hashing.h"
+#include "indicators.h"
+#include "mapped_file.h"
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+static const char RUN_STATE_MAGIC[8] = {'T', 'S', 'O', 'R', 'U', 'N', '\0', '\0'};
+static const uint32_t RUN_STATE_BYTE_ORDER = 0x01020304;
+
+// Append raw values to a byte buffer, and read them back with bounds checks
+static void put(std::vector<char>& out, const void* data, std::size_t size) {
+    out.insert(out.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+}
+
+template <typename T>
+static void putValue(std::vector<char>& out, const T& value) {
+    put(out, &value, sizeof(value));
+}
+
+struct StateReader {
+    const char* data;
+    std::size_t size;
+    std::size_t offset;
+
+    bool get(void* target, std::size_t bytes) {
+        if (bytes > size - offset) {
+            return false;
+        }
+        std::memcpy(target, data + offset, bytes);
+        offset += bytes;
+        return true;
+    }
+
+    template <typename T>
+    bool getValue(T& value) {
+        return get(&value, sizeof(value));
+    }
+
+    // A count of `element` bytes each that the rest of the body can actually hold
+    bool getCount(uint64_t& count, std::size_t element) {
+        return getValue(count) && count <= (size - offset) / element;
+    }
+};
+
+bool RunState::save(const std::string& path) const {
+    std::vector<char> body;
+    for (const auto& variant : lanes) {
+        for (const LaneState& lane : variant) {
+            putValue(body, lane.metrics);
+            putValue(body, lane.next_bar);
+            putValue(body, static_cast<uint64_t>(lane.positions.size()));
+            put(body, lane.positions.data(), lane.positions.size() * sizeof(OpenPosition));
+        }
+    }
+    for (const auto& entry : tails) {
+        const IndicatorTail& tail = entry.second;
+        putValue(body, entry.first);
+        putValue(body, tail.bar);
+        putValue(body, static_cast<uint64_t>(tail.registers.size()));
+        putValue(body, static_cast<uint64_t>(tail.history.size()));
+        put(body, tail.registers.data(), tail.registers.size() * sizeof(double));
+        put(body, tail.history.data(), tail.history.size() * sizeof(double));
+    }
+
+    RunStateHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, RUN_STATE_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.byte_order = RUN_STATE_BYTE_ORDER;
+    header.bars = bars;
+    header.capture_bar = capture_bar;
+    std::memcpy(header.column_ids, column_ids, sizeof(header.column_ids));
+    header.grid = grid;
+    header.variant_count = lanes.size();
+    header.lanes_per_variant = lanes.empty() ? 0 : lanes.front().size();
+    header.tail_count = tails.size();
+    header.body_size = body.size();
+    header.body_checksum = hashBytes64(body.data(), body.size());
+
+    bool written = writeFileAtomically(path, [&](std::ostream& out) {
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(body.data(), static_cast<std::streamsize>(body.size()));
+    });
+    if (!written) {
+        std::cerr << "Cannot write run state " << path << std::endl;
+    }
+    return written;
+}
+
+bool RunState::load(const std::string& path, RunState& state) {
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        return false;
+    }
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Cannot read run state " << path << std::endl;
+        return false;
+    }
+
+    RunStateHeader header;
+    if (file.size() < sizeof(header)) {
+        std::cerr << "Ignoring corrupt run state " << path << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, RUN_STATE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != FORMAT_VERSION ||
+        header.byte_order != RUN_STATE_BYTE_ORDER) {
+        std::cerr << "Ignoring run state " << path << " from another format version" << std::endl;
+        return false;
+    }
+    const char* body = file.data() + sizeof(header);
+    if (header.body_size != file.size() - sizeof(header) ||
+        header.body_checksum != hashBytes64(body, header.body_size)) {
+        std::cerr << "Ignoring corrupt run state " << path << std::endl;
+        return false;
+    }
+
+    RunState loaded;
+    loaded.bars = header.bars;
+    loaded.capture_bar = header.capture_bar;
+    std::memcpy(loaded.column_ids, header.column_ids, sizeof(loaded.column_ids));
+    loaded.grid = header.grid;
+
+    StateReader reader = {body, static_cast<std::size_t>(header.body_size), 0};
+    const std::size_t lane_bytes = sizeof(MetricsAccumulator) + 2 * sizeof(uint64_t);
+    bool ok = header.variant_count <= header.body_size &&
+              (header.lanes_per_variant == 0 ||
+               header.variant_count <= header.body_size / lane_bytes / header.lanes_per_variant);
+    if (ok) {
+        loaded.lanes.resize(header.variant_count);
+    }
+    for (uint64_t v = 0; ok && v < header.variant_count; ++v) {
+        loaded.lanes[v].resize(header.lanes_per_variant);
+        for (LaneState& lane : loaded.lanes[v]) {
+            uint64_t positions = 0;
+            ok = reader.getValue(lane.metrics) && reader.getValue(lane.next_bar) &&
+                 reader.getCount(positions, sizeof(OpenPosition));
+            if (!ok) {
+                break;
+            }
+            lane.positions.resize(positions);
+            ok = reader.get(lane.positions.data(), positions * sizeof(OpenPosition));
+        }
+    }
+    for (uint64_t t = 0; ok && t < header.tail_count; ++t) {
+        uint64_t recipe = 0;
+        uint64_t registers = 0;
+        uint64_t history = 0;
+        IndicatorTail tail;
+        ok = reader.getValue(recipe) && reader.getValue(tail.bar) && reader.getCount(registers, sizeof(double)) &&
+             reader.getCount(history, sizeof(double)) && registers + history <= (reader.size - reader.offset) / sizeof(double);
+        if (ok) {
+            tail.registers.resize(registers);
+            tail.history.resize(history);
+            ok = reader.get(tail.registers.data(), registers * sizeof(double)) &&
+                 reader.get(tail.history.data(), history * sizeof(double));
+            loaded.tails[recipe] = std::move(tail);
+        }
+    }
+    if (!ok || reader.offset != reader.size) {
+        std::cerr << "Ignoring corrupt run state " << path << std::endl;
+        return false;
+    }
+
+    state = std::move(loaded);
+    return true;
+}
+
+bool RunState::continues(const PriceSeries& prices) const {
+    if (bars == 0 || prices.size() < bars) {
+        return false;
+    }
+    const SeriesView columns[5] = {prices.opens(), prices.highs(), prices.lows(), prices.closes(), prices.volumes()};
+    for (int c = 0; c < 5; ++c) {
+        if (seriesContentId(columns[c].data(), static_cast<std::size_t>(bars)) != column_ids[c]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const PriceSeries> RunState::window(const std::shared_ptr<const PriceSeries>& prices,
+                                                    std::size_t first_bar) {
+    const PriceSeries& series = *prices;
+    return PriceSeries::fromMapped(prices, &series.timestamps()[first_bar],
+                                   series.opens().data() + first_bar, series.highs().data() + first_bar,
+                                   series.lows().data() + first_bar, series.closes().data() + first_bar,
+                                   series.volumes().data() + first_bar, series.size() - first_bar,
+                                   hashCombine64(series.checksum(), first_bar), nullptr, series.hasTimeOfDay());
+}
+
+IncrementalRunEngine::IncrementalRunEngine(const TradeSimulator& window_simulator,
+                                           const std::vector<double>& sl_pcts,
+                                           const std::vector<double>& tp_pcts,
+                                           bool enable_sl,
+                                           bool enable_tp,
+                                           bool enable_pyramiding)
+    : simulator(window_simulator), sl_percents(sl_pcts), tp_percents(tp_pcts),
+      use_sl(enable_sl), use_tp(enable_tp), pyramiding(enable_pyramiding) {}
+
+uint64_t IncrementalRunEngine::fingerprint(std::size_t variant_count,
+                                           const VariantKey& variant_key,
+                                           const ParamGrid& grid,
+                                           const std::vector<double>& sl_percents,
+                                           const std::vector<double>& tp_percents,
+                                           bool use_sl,
+                                           bool use_tp,
+                                           bool pyramiding) {
+    uint64_t h = hashCombine64(variant_count, (use_sl ? 1 : 0) | (use_tp ? 2 : 0) | (pyramiding ? 4 : 0));
+    h = hashCombine64(h, IndicatorCache::OUTPUT_VERSION);
+    h = hashCombine64(h, grid.fingerprint());
+    for (std::size_t v = 0; v < variant_count; ++v) {
+        h = hashCombine64(h, variant_key(v).hash());
+    }
+    h = hashCombine64(h, hashBytes64(sl_percents.data(), sl_percents.size() * sizeof(double), sl_percents.size()));
+    return hashCombine64(h, hashBytes64(tp_percents.data(), tp_percents.size() * sizeof(double), tp_percents.size()));
+}
+
+bool IncrementalRunEngine::run(std::vector<std::vector<LaneState>>& lanes,
+                               std::size_t first_bar,
+                               const VariantKey& variant_key,
+                               const SignalSource& signals,
+                               const BacktestFilter& filter,
+                               std::vector<BacktestResult>& results,
+                               ThreadPool& pool) const {
+    const std::size_t lane_count = sl_percents.size() * tp_percents.size();
+    for (const auto& variant : lanes) {
+        if (variant.size() != lane_count) {
+            std::cerr << "Saved run has " << variant.size() << " SL/TP lanes per variant, the grid has "
+                      << lane_count << std::endl;
+            return false;
+        }
+    }
+
+    // Results are kept per variant so they come out in grid order
+    std::vector<std::vector<BacktestResult>> passed(lanes.size());
+    std::atomic<bool> failed(false);
+    parallelFor(lanes.size(), 1, [&](std::size_t begin, std::size_t end) {
+        std::vector<int> dir;
+        std::vector<BacktestMetrics> metrics;
+        for (std::size_t variant = begin; variant < end; ++variant) {
+            // A variant without signals yields no results; its lanes only move on to the new end
+            const bool has_signals = signals(variant, dir);
+            if (!has_signals) {
+                dir.assign(simulator.size(), 0);
+            }
+            if (!simulator.continueMetrics(dir, sl_percents, tp_percents, use_sl, use_tp, pyramiding,
+                                           lanes[variant], metrics, first_bar)) {
+                failed = true;
+                continue;
+            }
+            if (!has_signals) {
+                continue;
+            }
+            const ParamKey key = variant_key(variant);
+            for (std::size_t lane = 0; lane < lane_count; ++lane) {
+                if (!filter.passes(metrics[lane])) {
+                    continue;
+                }
+                BacktestResult result;
+                metrics[lane].applyTo(result);
+                result.param_key = laneKey(key, lane, tp_percents.size(), use_sl, use_tp, pyramiding);
+                passed[variant].push_back(std::move(result));
+            }
+        }
+    }, pool);
+
+    for (auto& variant : passed) {
+        results.insert(results.end(), std::make_move_iterator(variant.begin()), std::make_move_iterator(variant.end()));
+    }
+    return !failed;
+}
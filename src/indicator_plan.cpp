@@ -0,0 +1,234 @@
+#include "indicator_plan.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+IndicatorPlan::Node IndicatorPlan::column(PriceColumn column) {
+    auto signature = std::make_tuple(-1 - static_cast<int>(column), -1, -1, -1, 0, 0.0);
+    auto it = step_index.find(signature);
+    if (it != step_index.end()) {
+        return it->second;
+    }
+
+    Step step = {true, column, IndicatorKind::VAR, {-1, -1, -1}, 0, 0.0, 0};
+    steps.push_back(step);
+    step_index[signature] = static_cast<Node>(steps.size() - 1);
+    return static_cast<Node>(steps.size() - 1);
+}
+
+IndicatorPlan::Node IndicatorPlan::addStep(IndicatorKind kind, Node a, Node b, Node c, int length, double multiplier) {
+    auto signature = std::make_tuple(static_cast<int>(kind), a, b, c, length, multiplier);
+    auto it = step_index.find(signature);
+    if (it != step_index.end()) {
+        return it->second;
+    }
+
+    Step step = {false, PriceColumn::Close, kind, {a, b, c}, length, multiplier, 0};
+    for (Node input : step.inputs) {
+        if (input >= 0) {
+            step.level = std::max(step.level, steps[input].level + 1);
+        }
+    }
+    steps.push_back(step);
+    step_index[signature] = static_cast<Node>(steps.size() - 1);
+    return static_cast<Node>(steps.size() - 1);
+}
+
+IndicatorPlan::Node IndicatorPlan::stochastic(Node closes, Node highs, Node lows, int k_length) {
+    return addStep(IndicatorKind::Stochastic, closes, highs, lows, k_length, 0.0);
+}
+
+IndicatorPlan::Node IndicatorPlan::rsi(Node closes, int length) {
+    return addStep(IndicatorKind::RSI, closes, -1, -1, length, 0.0);
+}
+
+IndicatorPlan::Node IndicatorPlan::var(Node data, int length) {
+    return addStep(IndicatorKind::VAR, data, -1, -1, length, 0.0);
+}
+
+IndicatorPlan::Node IndicatorPlan::ott(Node data, double multiplier) {
+    return addStep(IndicatorKind::OTT, data, -1, -1, 0, multiplier);
+}
+
+IndicatorPlan::Node IndicatorPlan::highest(Node data, int period) {
+    return addStep(IndicatorKind::Highest, data, -1, -1, period, 0.0);
+}
+
+IndicatorPlan::Node IndicatorPlan::lowest(Node data, int period) {
+    return addStep(IndicatorKind::Lowest, data, -1, -1, period, 0.0);
+}
+
+IndicatorPlan::Node IndicatorPlan::atr(Node highs, Node lows, Node closes, int period) {
+    return addStep(IndicatorKind::ATR, highs, lows, closes, period, 0.0);
+}
+
+IndicatorPlan::Node IndicatorPlan::bollingerBands(Node data, int length, double multiplier) {
+    return addStep(IndicatorKind::BollingerBands, data, -1, -1, length, multiplier);
+}
+
+std::size_t IndicatorPlan::size() const {
+    return static_cast<std::size_t>(std::count_if(steps.begin(), steps.end(), [](const Step& step) {
+        return !step.is_column;
+    }));
+}
+
+int IndicatorPlan::depth() const {
+    int levels = 0;
+    for (const auto& step : steps) {
+        levels = std::max(levels, step.level);
+    }
+    return levels;
+}
+
+void IndicatorPlan::execute(IndicatorCache& cache, const PriceSeries& prices, ThreadPool& pool) const {
+    const Node count = static_cast<Node>(steps.size());
+
+    // One task per node, except OTT and VAR nodes, which are grouped per input into one batch
+    std::vector<std::vector<Node>> tasks;
+    std::vector<int> task_of(count, -1);
+    std::vector<int> ott_task(count, -1);
+    std::vector<int> var_task(count, -1);
+    for (Node node = 0; node < count; ++node) {
+        const Step& step = steps[node];
+        if (step.is_column) {
+            continue;
+        }
+        if (step.kind == IndicatorKind::OTT || step.kind == IndicatorKind::VAR) {
+            int& task = (step.kind == IndicatorKind::OTT ? ott_task : var_task)[step.inputs[0]];
+            if (task < 0) {
+                task = static_cast<int>(tasks.size());
+                tasks.emplace_back();
+            }
+            tasks[task].push_back(node);
+            task_of[node] = task;
+        } else {
+            task_of[node] = static_cast<int>(tasks.size());
+            tasks.push_back({node});
+        }
+    }
+
+    // Views of every node for its consumers, the handles that keep them alive until their
+    // last consumer is done, and the task graph: which tasks wait on which
+    std::vector<SeriesView> views(count);
+    std::vector<CachedSeries> handles(count);
+    std::vector<std::vector<Node>> task_inputs(tasks.size());
+    std::vector<std::vector<int>> dependents(tasks.size());
+    std::unique_ptr<std::atomic<int>[]> consumers_left(new std::atomic<int>[count]);
+    std::unique_ptr<std::atomic<int>[]> inputs_left(new std::atomic<int>[tasks.size()]);
+    for (Node node = 0; node < count; ++node) {
+        consumers_left[node].store(0);
+    }
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        std::vector<Node>& inputs = task_inputs[t];
+        for (Node node : tasks[t]) {
+            for (Node input : steps[node].inputs) {
+                if (input >= 0 && std::find(inputs.begin(), inputs.end(), input) == inputs.end()) {
+                    inputs.push_back(input);
+                }
+            }
+        }
+        int waiting = 0;
+        for (Node input : inputs) {
+            consumers_left[input].fetch_add(1);
+            if (!steps[input].is_column) {
+                dependents[task_of[input]].push_back(static_cast<int>(t));
+                waiting++;
+            }
+        }
+        inputs_left[t].store(waiting);
+    }
+    for (Node node = 0; node < count; ++node) {
+        if (steps[node].is_column) {
+            switch (steps[node].column) {
+                case PriceColumn::Open: views[node] = prices.opens(); break;
+                case PriceColumn::High: views[node] = prices.highs(); break;
+                case PriceColumn::Low: views[node] = prices.lows(); break;
+                case PriceColumn::Close: views[node] = prices.closes(); break;
+            }
+        }
+    }
+
+    auto compute = [&](const std::vector<Node>& task) {
+        const Step& first = steps[task.front()];
+        if (first.kind == IndicatorKind::OTT) {
+            std::vector<double> multipliers;
+            for (Node node : task) {
+                multipliers.push_back(steps[node].multiplier);
+            }
+            std::vector<CachedSeries> results = cache.getOTTBatch(views[first.inputs[0]], multipliers);
+            for (size_t k = 0; k < task.size(); ++k) {
+                handles[task[k]] = results[k];
+            }
+            return;
+        }
+        if (first.kind == IndicatorKind::VAR) {
+            std::vector<int> lengths;
+            for (Node node : task) {
+                lengths.push_back(steps[node].length);
+            }
+            std::vector<CachedSeries> results = cache.getVARBatch(views[first.inputs[0]], lengths);
+            for (size_t k = 0; k < task.size(); ++k) {
+                handles[task[k]] = results[k];
+            }
+            return;
+        }
+
+        SeriesView a = first.inputs[0] >= 0 ? views[first.inputs[0]] : SeriesView();
+        SeriesView b = first.inputs[1] >= 0 ? views[first.inputs[1]] : SeriesView();
+        SeriesView c = first.inputs[2] >= 0 ? views[first.inputs[2]] : SeriesView();
+        CachedSeries& out = handles[task.front()];
+        switch (first.kind) {
+            case IndicatorKind::Stochastic: out = cache.getStochastic(a, b, c, first.length); break;
+            case IndicatorKind::RSI: out = cache.getRSI(a, first.length); break;
+            case IndicatorKind::Highest: out = cache.getHighest(a, first.length); break;
+            case IndicatorKind::Lowest: out = cache.getLowest(a, first.length); break;
+            case IndicatorKind::ATR: out = cache.getATR(a, b, c, first.length); break;
+            case IndicatorKind::AbsChange: out = cache.getAbsChange(a, first.length); break;
+            case IndicatorKind::SumAbsChanges: out = cache.getSumAbsChanges(a, first.length); break;
+            case IndicatorKind::BollingerBands:
+                // Consumers read the bands themselves; the node only needs them cached
+                cache.getBollingerBands(a, first.length, first.multiplier);
+                break;
+            case IndicatorKind::VAR:
+            case IndicatorKind::OTT:
+                break;
+        }
+    };
+
+    TaskGroup group(pool);
+    std::function<void(int)> runTask = [&](int t) {
+        compute(tasks[t]);
+
+        // Publish the results, release inputs this was the last reader of, then start every
+        // dependent whose inputs are now all ready
+        for (Node node : tasks[t]) {
+            views[node] = handles[node];
+            if (consumers_left[node].load() == 0) {
+                handles[node] = CachedSeries();
+            }
+        }
+        for (Node input : task_inputs[t]) {
+            if (consumers_left[input].fetch_sub(1) == 1) {
+                handles[input] = CachedSeries();
+            }
+        }
+        for (int dependent : dependents[t]) {
+            if (inputs_left[dependent].fetch_sub(1) == 1) {
+                group.run([&runTask, dependent]() { runTask(dependent); });
+            }
+        }
+    };
+    // The tasks without inputs are picked before any runs; once tasks finish, their dependents'
+    // counts reach zero too and those are started by the task that got them there
+    std::vector<int> roots;
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        if (inputs_left[t].load() == 0) {
+            roots.push_back(static_cast<int>(t));
+        }
+    }
+    for (int t : roots) {
+        group.run([&runTask, t]() { runTask(t); });
+    }
+    group.wait();
+}
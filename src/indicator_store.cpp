@@ -0,0 +1,95 @@
+#include "indicator_store.h"
+#include "hashing.h"
+#include "mapped_file.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+static const char INDICATOR_STORE_MAGIC[8] = {'T', 'S', 'O', 'I', 'N', 'D', '\0', '\0'};
+static const uint32_t INDICATOR_STORE_BYTE_ORDER = 0x01020304;
+
+static_assert(sizeof(IndicatorStoreHeader) == 64, "stored values must start cache-line aligned");
+
+IndicatorStore::IndicatorStore(const std::string& dir) : directory(dir), write_failed(false) {}
+
+std::shared_ptr<IndicatorStore> IndicatorStore::open(const std::string& dir) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (!std::filesystem::is_directory(dir, ec)) {
+        std::cerr << "Cannot use indicator store " << dir << ": not a directory" << std::endl;
+        return nullptr;
+    }
+    return std::shared_ptr<IndicatorStore>(new IndicatorStore(dir));
+}
+
+std::string IndicatorStore::path(const IndicatorKey& key) const {
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.ind", static_cast<unsigned long long>(key.id()));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+bool IndicatorStore::load(const IndicatorKey& key, CachedSeries& series) const {
+    const std::string file_path = path(key);
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(file_path)) {
+        return false;
+    }
+
+    IndicatorStoreHeader header;
+    if (file->size() < sizeof(header)) {
+        std::cerr << "Warning: ignoring corrupt stored indicator " << file_path << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, INDICATOR_STORE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != FORMAT_VERSION ||
+        header.byte_order != INDICATOR_STORE_BYTE_ORDER) {
+        return false;
+    }
+
+    // Another key whose id collides is a miss; the file is replaced once this key is computed
+    if (header.kind != static_cast<uint32_t>(key.kind) || header.input != key.input ||
+        header.length != key.length || header.multiplier != key.multiplier) {
+        return false;
+    }
+    const char* values = file->data() + sizeof(header);
+    if (header.count != (file->size() - sizeof(header)) / sizeof(double) ||
+        file->size() != sizeof(header) + header.count * sizeof(double) ||
+        header.checksum != hashBytes64(values, header.count * sizeof(double))) {
+        std::cerr << "Warning: ignoring corrupt stored indicator " << file_path << std::endl;
+        return false;
+    }
+
+    // The series is used in place; the mapping lives as long as any handle to it
+    series = CachedSeries(std::shared_ptr<const double>(file, reinterpret_cast<const double*>(values)),
+                          static_cast<std::size_t>(header.count), key.id());
+    return true;
+}
+
+bool IndicatorStore::save(const IndicatorKey& key, const double* values, std::size_t count) {
+    IndicatorStoreHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, INDICATOR_STORE_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.byte_order = INDICATOR_STORE_BYTE_ORDER;
+    header.kind = static_cast<uint32_t>(key.kind);
+    header.length = key.length;
+    header.multiplier = key.multiplier;
+    header.input = key.input;
+    header.count = count;
+    header.checksum = hashBytes64(values, count * sizeof(double));
+
+    bool written = writeFileAtomically(path(key), [&](std::ostream& out) {
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(double)));
+    });
+    if (!written) {
+        if (!write_failed.exchange(true)) {
+            std::cerr << "Warning: cannot write to indicator store " << directory
+                      << ", computed indicators are not being stored" << std::endl;
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+#include "indicator_tails.h"
+#include "hashing.h"
+
+IndicatorTails::IndicatorTails(std::size_t window_first_bar,
+                               std::size_t capture_at,
+                               std::unordered_map<uint64_t, IndicatorTail> previous)
+    : first_bar(window_first_bar), capture_index(capture_at), seeds(std::move(previous)), incomplete(false) {}
+
+void IndicatorTails::addColumns(const PriceSeries& window) {
+    const uint64_t ids[5] = {window.opens().id(), window.highs().id(), window.lows().id(),
+                             window.closes().id(), window.volumes().id()};
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int c = 0; c < 5; ++c) {
+        // Columns with identical contents cannot be told apart by id; series derived from
+        // them get no recipe, so a run that uses them is never continued
+        const uint64_t recipe = hashCombine64(0x7461696c73ULL, static_cast<uint64_t>(c));
+        auto inserted = recipes.emplace(ids[c], recipe);
+        if (!inserted.second && inserted.first->second != recipe) {
+            inserted.first->second = 0;
+        }
+    }
+}
+
+bool IndicatorTails::recipeOf(uint64_t id, uint64_t& recipe) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = recipes.find(id);
+    if (it == recipes.end() || it->second == 0) {
+        return false;
+    }
+    recipe = it->second;
+    return true;
+}
+
+void IndicatorTails::addRecipe(uint64_t id, uint64_t recipe) {
+    std::lock_guard<std::mutex> lock(mutex);
+    recipes[id] = recipe;
+}
+
+const IndicatorTail* IndicatorTails::seed(uint64_t recipe) const {
+    auto it = seeds.find(recipe);
+    return it != seeds.end() ? &it->second : nullptr;
+}
+
+void IndicatorTails::capture(uint64_t recipe, IndicatorTail tail) {
+    std::lock_guard<std::mutex> lock(mutex);
+    captured[recipe] = std::move(tail);
+}
+
+void IndicatorTails::markIncomplete() {
+    std::lock_guard<std::mutex> lock(mutex);
+    incomplete = true;
+}
+
+bool IndicatorTails::complete() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !incomplete;
+}
+
+std::unordered_map<uint64_t, IndicatorTail> IndicatorTails::capturedTails() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return captured;
+}
@@ -2,70 +2,432 @@
 #include <cmath>
 #include <algorithm>
 #include <limits>
+#include <functional>
+#include <cstring>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
+#include "hashing.h"
+#include "indicator_store.h"
+#include "simd_kernels.h"
 
-const std::vector<double>& IndicatorCache::getStochastic(const std::vector<double>& closes, 
-                                                      const std::vector<double>& highs, 
-                                                      const std::vector<double>& lows, 
-                                                      int k_length) {
-    std::string cache_key = "stoch_" + std::to_string(k_length);
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = indicator_cache.find(cache_key);
-        if (it != indicator_cache.end()) {
-            return it->second;
+// Neumaier-compensated running sum; keeps add/remove streams accurate over millions of updates
+struct CompensatedSum {
+    double sum = 0.0;
+    double compensation = 0.0;
+    
+    void add(double v) {
+        double t = sum + v;
+        if (std::abs(sum) >= std::abs(v)) {
+            compensation += (sum - t) + v;
+        } else {
+            compensation += (v - t) + sum;
         }
+        sum = t;
     }
     
-    // Calculate Stochastic %K
-    std::vector<double> result(closes.size(), 0.0);
+    double value() const { return sum + compensation; }
+};
+
+// A cached series and the state of its one-time computation
+struct IndicatorCache::Entry {
+    enum State : int { Computing, Ready, Failed, Evicted };
+    
+    IndicatorKey key;
+    std::atomic<int> state;
+    
+    // Set before state becomes Ready and cleared only by evict(). Readers copy it only under
+    // their own Readers lock and after seeing Ready; evict() holds every Readers lock while it
+    // resets it, so the two never race.
+    std::shared_ptr<const double> values;
+    std::atomic<std::size_t> length;
+    
+    // Value of access_clock when the series was last handed out
+    std::atomic<uint64_t> last_used;
+    
+    // Threads that need the series while it is being computed sleep here
+    std::mutex wait_mutex;
+    std::condition_variable state_changed;
     
-    for (int i = k_length; i < closes.size(); ++i) {
-        // Find lowest low and highest high over k_length
-        double lowest_low = std::numeric_limits<double>::max();
-        double highest_high = std::numeric_limits<double>::lowest();
+    explicit Entry(const IndicatorKey& k) : key(k), state(Computing), length(0), last_used(0) {}
+};
+
+// One thread's view of the cache. `handles` holds a handle per ready series the thread has
+// read, each with a control block of its own around one reference to the entry's buffer, so
+// repeated hits copy a shared_ptr no other thread counts on instead of the entry's. The lock
+// is only contended while evict() or clear() release handles.
+struct alignas(64) IndicatorCache::Readers {
+    std::thread::id owner;
+    std::mutex mutex;
+    std::unordered_map<const Entry*, std::shared_ptr<const double>> handles;
+    std::atomic<uint64_t> hits{0};  // Written by the owner only
+};
+
+// Readers of the calling thread in the cache it last read from
+struct ReadersCache {
+    uint64_t cache_id = 0;
+    void* readers = nullptr;
+};
+
+static thread_local ReadersCache readers_cache;
+static std::atomic<uint64_t> next_cache_id(1);
+
+// Power-of-two open-addressing table of entry pointers, probed linearly. Slots only ever
+// go from null to an entry, so a reader that sees an entry can use it without locking.
+struct IndicatorCache::Table {
+    std::size_t mask;
+    std::size_t used;
+    std::unique_ptr<std::atomic<Entry*>[]> slots;
+    
+    explicit Table(std::size_t capacity) : mask(capacity - 1), used(0), slots(new std::atomic<Entry*>[capacity]) {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    
+    Entry* find(const IndicatorKey& key, uint64_t hash) const {
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            Entry* entry = slots[i].load(std::memory_order_acquire);
+            if (entry == nullptr || entry->key == key) {
+                return entry;
+            }
+        }
+    }
+    
+    void insert(Entry* entry, uint64_t hash) {
+        std::size_t i = hash & mask;
+        while (slots[i].load(std::memory_order_relaxed) != nullptr) {
+            i = (i + 1) & mask;
+        }
+        slots[i].store(entry, std::memory_order_release);
+        ++used;
+    }
+};
+
+// One thread's hold on a cache entry: either the series is ready, or this thread owns its
+// computation and must publish the result. An owner that leaves without publishing (an
+// exception in the indicator code) marks the entry failed so a waiting thread can take over.
+// Failed and evicted entries are recomputed (or loaded from the store) by the next thread
+// that claims them.
+class IndicatorCache::Claim {
+private:
+    IndicatorCache& cache;
+    Entry* entry;
+    std::shared_ptr<const double> values;
+    bool owner;
+
+public:
+    // With `wait`, blocks until the series is ready or this thread owns it; without, a
+    // series that another thread is computing is left as neither ready nor owned
+    Claim(IndicatorCache& owner_cache, const IndicatorKey& key, bool wait = true) : cache(owner_cache), owner(false) {
+        entry = cache.findEntry(key);
+        if (entry == nullptr) {
+            entry = cache.insertEntry(key, owner);
+            if (owner) {
+                cache.countMiss();
+                loadStored();
+                return;
+            }
+        }
         
-        for (int j = i - k_length + 1; j <= i; ++j) {
-            if (j >= 0) {
-                lowest_low = std::min(lowest_low, lows[j]);
-                highest_high = std::max(highest_high, highs[j]);
+        for (;;) {
+            int state = entry->state.load(std::memory_order_acquire);
+            if (state == Entry::Ready) {
+                if (cache.readHandle(entry, values)) {
+                    touch();
+                    return;
+                }
+                // Evicted since the state was loaded
+                continue;
             }
+            if (state == Entry::Failed || state == Entry::Evicted) {
+                if (entry->state.compare_exchange_strong(state, Entry::Computing, std::memory_order_acq_rel)) {
+                    cache.countMiss();
+                    owner = true;
+                    loadStored();
+                    return;
+                }
+                continue;
+            }
+            if (!wait) {
+                return;
+            }
+            std::unique_lock<std::mutex> lock(entry->wait_mutex);
+            entry->state_changed.wait(lock, [this] {
+                return entry->state.load(std::memory_order_acquire) != Entry::Computing;
+            });
+        }
+    }
+    
+    ~Claim() {
+        if (owner) {
+            std::lock_guard<std::mutex> lock(entry->wait_mutex);
+            entry->state.store(Entry::Failed, std::memory_order_release);
+            entry->state_changed.notify_all();
+        }
+    }
+    
+    Claim(const Claim&) = delete;
+    Claim& operator=(const Claim&) = delete;
+    
+    bool ready() const { return values != nullptr; }
+    bool owned() const { return owner; }
+    const IndicatorKey& key() const { return entry->key; }
+    
+    CachedSeries series() const {
+        return CachedSeries(values, entry->length.load(std::memory_order_relaxed), entry->key.id());
+    }
+    
+    // Freeze the computed values, wake every thread waiting for them, make room for them
+    // within the memory budget and write them to the store
+    CachedSeries publish(std::vector<double>&& computed) {
+        auto buffer = std::make_shared<const std::vector<double>>(std::move(computed));
+        CachedSeries result = adopt(std::shared_ptr<const double>(buffer, buffer->data()), buffer->size());
+        if (cache.store && !cache.tails && cache.store->save(entry->key, result.data(), result.size())) {
+            cache.store_saves.fetch_add(1, std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+private:
+    // A series already in the store is mapped instead of computed; the claim is then ready
+    void loadStored() {
+        CachedSeries stored;
+        if (cache.store && !cache.tails && cache.store->load(entry->key, stored)) {
+            cache.store_loads.fetch_add(1, std::memory_order_relaxed);
+            adopt(stored.storage(), stored.size());
+        }
+    }
+    
+    CachedSeries adopt(std::shared_ptr<const double> buffer, std::size_t length) {
+        values = std::move(buffer);
+        entry->length.store(length, std::memory_order_relaxed);
+        entry->values = values;
+        touch();
+        {
+            std::lock_guard<std::mutex> lock(entry->wait_mutex);
+            entry->state.store(Entry::Ready, std::memory_order_release);
+            entry->state_changed.notify_all();
         }
+        owner = false;
         
-        // Calculate %K
-        if (highest_high - lowest_low > 0) {
-            result[i] = (closes[i] - lowest_low) / (highest_high - lowest_low) * 100.0;
-        } else {
-            result[i] = 100.0; // Default value when there's no range
+        // The handle returned below keeps this series pinned while the budget is enforced
+        CachedSeries result = series();
+        cache.addResident(result.size() * sizeof(double));
+        return result;
+    }
+    
+    // Only write the entry's timestamp when it changes, so hot entries shared by many threads
+    // are not written on every hit
+    void touch() {
+        uint64_t now = cache.access_clock.load(std::memory_order_relaxed);
+        if (entry->last_used.load(std::memory_order_relaxed) != now) {
+            entry->last_used.store(now, std::memory_order_relaxed);
         }
     }
+};
+
+// A kernel's input reaching back into the previous run: values[h + i] is bar i of the window
+// and the h values before it are the tail's history, so values[0] is absolute bar `base`.
+// Without a tail to continue from it is the series itself.
+struct TailInput {
+    std::vector<double> joined;
+    const double* values;
+    size_t h;
+    size_t base;
+};
+
+struct IndicatorTailLink {
+    IndicatorTails* tails = nullptr;
+    uint64_t recipe = 0;
+    const IndicatorTail* seed = nullptr;
+    size_t first_bar = 0;       // Absolute bar of series index 0
+    size_t capture = SIZE_MAX;  // Series index whose tail this run records
     
-    // Cache and return
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        indicator_cache[cache_key] = result;
-        return indicator_cache[cache_key];
+    // Whether the recurrence continues from the tail's registers instead of from bar 0
+    bool warm() const { return seed != nullptr && !seed->registers.empty(); }
+    
+    // Whether a tail is captured within a series of n bars (at index `capture`)
+    bool captures(size_t n) const { return tails != nullptr && capture <= n; }
+    
+    // Index to stop at before capturing, so the computation runs as [0, pause) and [pause, n)
+    size_t pause(size_t n) const { return captures(n) ? capture : n; }
+    
+    // `data` with part `part` of the tail's history (split into `parts` equal parts) before it
+    TailInput input(SeriesView data, size_t part = 0, size_t parts = 1) const {
+        TailInput in;
+        in.values = data.data();
+        in.h = 0;
+        in.base = first_bar;
+        if (seed != nullptr && !seed->history.empty()) {
+            const size_t h = seed->history.size() / parts;
+            const double* history = seed->history.data() + part * h;
+            in.joined.reserve(h + data.size());
+            in.joined.assign(history, history + h);
+            in.joined.insert(in.joined.end(), data.begin(), data.end());
+            in.values = in.joined.data();
+            in.h = h;
+            in.base = first_bar - h;
+        }
+        return in;
+    }
+    
+    // The last `lookback` inputs before window index k, or all of them since bar 0 if fewer
+    static std::vector<double> history(const TailInput& in, size_t k, size_t lookback) {
+        const size_t end = in.h + k;
+        const size_t count = std::min({lookback, in.base + end, end});
+        return std::vector<double>(in.values + end - count, in.values + end);
     }
+    
+    // Name the series with id hashCombine64(id, part), derived from this one
+    void derive(uint64_t id, uint64_t part) const {
+        if (tails != nullptr) {
+            tails->addRecipe(hashCombine64(id, part), hashCombine64(recipe, part));
+        }
+    }
+    
+    void store(size_t k, std::vector<double> registers, std::vector<double> history) const {
+        IndicatorTail tail;
+        tail.bar = first_bar + k;
+        tail.registers = std::move(registers);
+        tail.history = std::move(history);
+        tails->capture(recipe, std::move(tail));
+    }
+};
+
+// Drop the leading history from an output computed over a TailInput
+static std::vector<double> dropHistory(std::vector<double>&& out, size_t h) {
+    out.erase(out.begin(), out.begin() + h);
+    return std::move(out);
 }
 
-const std::vector<double>& IndicatorCache::getRSI(const std::vector<double>& closes, int length) {
-    std::string cache_key = "rsi_" + std::to_string(length);
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = indicator_cache.find(cache_key);
-        if (it != indicator_cache.end()) {
-            return it->second;
+// Sliding-window extremum over [i - period + 1, i] (clipped at 0) for every i, using a
+// monotonic deque of indices kept in a ring buffer. Each index is pushed and popped at
+// most once, so the cost is O(n) regardless of the window size. `Better` is
+// std::greater<double> for a rolling max and std::less<double> for a rolling min.
+template <typename Better>
+static void rollingExtremum(SeriesView data, int period, std::vector<double>& out, Better better) {
+    const size_t n = data.size();
+    const size_t window = static_cast<size_t>(std::max(period, 1));
+    out.resize(n);
+    
+    std::vector<size_t> ring(std::min(window, std::max<size_t>(n, 1)));
+    const size_t capacity = ring.size();
+    size_t head = 0;
+    size_t count = 0;
+    
+    for (size_t i = 0; i < n; ++i) {
+        // Drop the front index once it falls out of the window
+        if (count > 0 && ring[head] + window <= i) {
+            head = head + 1 == capacity ? 0 : head + 1;
+            --count;
+        }
+        
+        // Drop back indices that can never be the extremum again
+        const double value = data[i];
+        while (count > 0) {
+            size_t back = head + count - 1;
+            if (back >= capacity) {
+                back -= capacity;
+            }
+            if (better(data[ring[back]], value)) {
+                break;
+            }
+            --count;
+        }
+        
+        size_t slot = head + count;
+        if (slot >= capacity) {
+            slot -= capacity;
         }
+        ring[slot] = i;
+        ++count;
+        
+        out[i] = data[ring[head]];
+    }
+}
+
+// Rolling extremum of a window, reaching back into the tail's history for its first bars
+template <typename Better>
+static std::vector<double> rollingExtremumOf(SeriesView data, int period, const IndicatorTailLink& tail, Better better) {
+    const size_t lookback = static_cast<size_t>(std::max(period, 1)) - 1;
+    TailInput in = tail.input(data);
+    std::vector<double> out;
+    rollingExtremum(SeriesView(in.values, in.h + data.size(), 0), period, out, better);
+    if (tail.captures(data.size())) {
+        tail.store(tail.capture, {}, IndicatorTailLink::history(in, tail.capture, lookback));
+    }
+    return dropHistory(std::move(out), in.h);
+}
+
+CachedSeries IndicatorCache::getStochastic(SeriesView closes, 
+                                           SeriesView highs, 
+                                           SeriesView lows, 
+                                           int k_length) {
+    uint64_t close_id = identify(closes);
+    uint64_t high_id = identify(highs);
+    uint64_t low_id = identify(lows);
+    uint64_t input = hashCombine64(hashCombine64(close_id, high_id), low_id);
+    IndicatorKey key = {IndicatorKind::Stochastic, input, k_length, 0.0};
+    Claim claim(*this, key);
+    if (claim.ready()) {
+        return claim.series();
+    }
+    IndicatorTailLink tail = tailLink(key, {close_id, high_id, low_id}, closes.size());
+    
+    // Calculate Stochastic %K from O(n) rolling extremes of the highs and lows; the tail
+    // keeps the last highs and lows before the window, one after the other
+    const size_t n = closes.size();
+    const size_t lookback = static_cast<size_t>(std::max(k_length, 1)) - 1;
+    TailInput high_input = tail.input(highs, 0, 2);
+    TailInput low_input = tail.input(lows, 1, 2);
+    std::vector<double> highest_high;
+    std::vector<double> lowest_low;
+    rollingExtremum(SeriesView(high_input.values, high_input.h + n, 0), k_length, highest_high, std::greater<double>());
+    rollingExtremum(SeriesView(low_input.values, low_input.h + n, 0), k_length, lowest_low, std::less<double>());
+    
+    // Calculate %K (100 when there's no range) from bar k_length on
+    std::vector<double> result(n, 0.0);
+    const size_t first_k = static_cast<size_t>(std::max(k_length, 0));
+    const size_t begin = std::min(n, first_k > tail.first_bar ? first_k - tail.first_bar : 0);
+    SimdKernels::active().stochasticK(closes.data(), highest_high.data() + high_input.h, lowest_low.data() + low_input.h,
+                                      begin, n, result.data());
+    
+    if (tail.captures(n)) {
+        std::vector<double> history = IndicatorTailLink::history(high_input, tail.capture, lookback);
+        std::vector<double> low_history = IndicatorTailLink::history(low_input, tail.capture, lookback);
+        history.insert(history.end(), low_history.begin(), low_history.end());
+        tail.store(tail.capture, {}, std::move(history));
     }
     
+    // Cache and return
+    return claim.publish(std::move(result));
+}
+
+CachedSeries IndicatorCache::getRSI(SeriesView closes, int length) {
+    uint64_t input = identify(closes);
+    IndicatorKey key = {IndicatorKind::RSI, input, length, 0.0};
+    Claim claim(*this, key);
+    if (claim.ready()) {
+        return claim.series();
+    }
+    IndicatorTailLink tail = tailLink(key, {input}, closes.size());
+    
+    // A warm tail holds the averages and the last close; a cold one every close since bar 0,
+    // which are simply run through again
+    TailInput in = tail.input(closes);
+    const double* x = in.values;
+    const size_t total = in.h + closes.size();
+    
     // Calculate RSI
-    std::vector<double> result(closes.size(), 0.0);
-    std::vector<double> changes(closes.size(), 0.0);
-    std::vector<double> gains(closes.size(), 0.0);
-    std::vector<double> losses(closes.size(), 0.0);
+    std::vector<double> result(total, 0.0);
+    std::vector<double> changes(total, 0.0);
+    std::vector<double> gains(total, 0.0);
+    std::vector<double> losses(total, 0.0);
     
     // Calculate price changes
-    for (size_t i = 1; i < closes.size(); i++) {
-        changes[i] = closes[i] - closes[i-1];
+    for (size_t i = 1; i < total; i++) {
+        changes[i] = x[i] - x[i-1];
         if (changes[i] > 0) {
             gains[i] = changes[i];
             losses[i] = 0;
@@ -75,371 +437,947 @@ const std::vector<double>& IndicatorCache::getRSI(const std::vector<double>& clo
         }
     }
     
-    // Calculate initial averages
     double avg_gain = 0;
     double avg_loss = 0;
+    size_t start = in.h;
+    if (tail.warm()) {
+        avg_gain = tail.seed->registers[0];
+        avg_loss = tail.seed->registers[1];
+    } else {
+        // Calculate initial averages
+        for (int i = 1; i <= length && static_cast<size_t>(i) < total; i++) {
+            avg_gain += gains[i];
+            avg_loss += losses[i];
+        }
+        
+        avg_gain /= length;
+        avg_loss /= length;
+        start = length + 1;
+    }
     
-    for (int i = 1; i <= length; i++) {
-        avg_gain += gains[i];
-        avg_loss += losses[i];
+    // Calculate RSI, in two parts with the tail captured between them
+    const size_t bounds[3] = {start, std::max(start, in.h + tail.pause(closes.size())), total};
+    for (int part = 0; part < 2; ++part) {
+        if (part == 1 && tail.captures(closes.size())) {
+            const size_t at = in.h + tail.capture;
+            if (at >= start) {
+                tail.store(tail.capture, {avg_gain, avg_loss}, {x[at - 1]});
+            } else {
+                tail.store(tail.capture, {}, std::vector<double>(x, x + at));
+            }
+        }
+        for (size_t i = bounds[part]; i < bounds[part + 1]; i++) {
+            // Update average gain and loss
+            avg_gain = (avg_gain * (length - 1) + gains[i]) / length;
+            avg_loss = (avg_loss * (length - 1) + losses[i]) / length;
+            
+            if (avg_loss == 0) {
+                result[i] = 100;
+            } else {
+                double rs = avg_gain / avg_loss;
+                result[i] = 100 - (100 / (1 + rs));
+            }
+        }
     }
     
-    avg_gain /= length;
-    avg_loss /= length;
+    // Cache and return
+    return claim.publish(dropHistory(std::move(result), in.h));
+}
+
+// Efficiency ratio |change over 9 bars| / sum of |bar changes| over the same 9 bars
+static void computeEfficiencyRatio(SeriesView momentum, SeriesView volatility, std::vector<double>& ratio) {
+    ratio.resize(momentum.size());
+    SimdKernels::active().efficiencyRatio(momentum.data(), volatility.data(), 0, momentum.size(), ratio.data());
+}
+
+// VIDYA recurrence for L lengths over the same efficiency ratio and bars [begin, end), one
+// length per lane, in the same layout as stepOTTLanes. prev[k] holds lane k's value before
+// `begin` and is left at its value before `end`. Each lane is bit-identical to running its
+// length alone. Length 1 is the series itself and is left to the caller, which keeps the
+// lanes select-free.
+template <size_t L>
+static void stepVARLanes(const double* data, const double* ratio, const double* alphas, double* prev_values,
+                         double* const* outputs, size_t begin, size_t end) {
+    double alpha[L], prev[L];
+    double* out[L];
+    for (size_t k = 0; k < L; ++k) {
+        alpha[k] = alphas[k];
+        prev[k] = prev_values[k];
+        out[k] = outputs[k];
+    }
     
-    // Calculate RSI
-    for (size_t i = length + 1; i < closes.size(); i++) {
-        // Update average gain and loss
-        avg_gain = (avg_gain * (length - 1) + gains[i]) / length;
-        avg_loss = (avg_loss * (length - 1) + losses[i]) / length;
-        
-        if (avg_loss == 0) {
-            result[i] = 100;
+    for (size_t i = begin; i < end; ++i) {
+        const double x = data[i];
+        const double er = ratio[i];
+        for (size_t k = 0; k < L; ++k) {
+            prev[k] = er * alpha[k] * (x - prev[k]) + prev[k];
+            out[k][i] = prev[k];
+        }
+    }
+    
+    for (size_t k = 0; k < L; ++k) {
+        prev_values[k] = prev[k];
+    }
+}
+
+// Run up to L VAR lanes over a whole series, from bar 0 or from their tails, capturing the
+// tails where the run asks for them
+template <size_t L>
+static void computeVARLanes(SeriesView data, const double* ratio, const int* lengths, std::vector<double>* const* outputs,
+                            const IndicatorTailLink* links, size_t active_lanes) {
+    const size_t n = data.size();
+    if (n == 0) {
+        return;
+    }
+    
+    double alpha[L], prev[L];
+    double* out[L];
+    size_t begin = 0;
+    for (size_t k = 0; k < L; ++k) {
+        // Unused lanes repeat the last length and write to its output again
+        size_t lane = std::min(k, active_lanes - 1);
+        alpha[k] = 2.0 / (lengths[lane] + 1.0);
+        out[k] = outputs[lane]->data();
+        if (links[lane].warm()) {
+            prev[k] = links[lane].seed->registers[0];
         } else {
-            double rs = avg_gain / avg_loss;
-            result[i] = 100 - (100 / (1 + rs));
+            prev[k] = data[0];
+            out[k][0] = data[0];
+            begin = 1;
         }
     }
     
-    // Cache and return
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        indicator_cache[cache_key] = result;
-        return indicator_cache[cache_key];
+    const size_t pause = std::max(begin, links[0].pause(n));
+    stepVARLanes<L>(data.data(), ratio, alpha, prev, out, begin, pause);
+    if (links[0].captures(n)) {
+        for (size_t k = 0; k < active_lanes; ++k) {
+            links[k].store(links[k].capture, {prev[k]}, {});
+        }
     }
+    stepVARLanes<L>(data.data(), ratio, alpha, prev, out, pause, n);
 }
 
-const std::vector<double>& IndicatorCache::getVAR(const std::vector<double>& data, int length) {
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = var_cache.find(length);
-        if (it != var_cache.end()) {
-            return it->second;
+CachedSeries IndicatorCache::getVAR(SeriesView data, int length) {
+    // Resolve the input identity once for this and the nested lookups
+    data = SeriesView(data.data(), data.size(), identify(data));
+    IndicatorKey key = {IndicatorKind::VAR, data.id(), length, 0.0};
+    Claim claim(*this, key);
+    if (claim.ready()) {
+        return claim.series();
+    }
+    IndicatorTailLink tail = tailLink(key, {data.id()}, data.size());
+    
+    // Calculate VAR (VIDYA) from the efficiency ratio of the 9-bar momentum and volatility
+    if (length == 1) {
+        if (tail.captures(data.size())) {
+            tail.store(tail.capture, {}, {});
         }
+        return claim.publish(std::vector<double>(data.begin(), data.end()));
     }
+    std::vector<double> ratio;
+    computeEfficiencyRatio(getAbsChange(data, 9), getSumAbsChanges(data, 9), ratio);
     
-    // Calculate VAR (VIDYA)
     std::vector<double> result(data.size(), 0.0);
+    std::vector<double>* output = &result;
+    computeVARLanes<1>(data, ratio.data(), &length, &output, &tail, 1);
     
-    // Get or calculate momentum (period 9)
-    std::vector<double> momentum = getAbsChange(data, 9);
-    
-    // Get or calculate volatility (period 9)
-    std::vector<double> volatility = getSumAbsChanges(data, 9);
+    // Cache and return
+    return claim.publish(std::move(result));
+}
+
+std::vector<CachedSeries> IndicatorCache::getVARBatch(SeriesView data, const std::vector<int>& lengths) {
+    const size_t lanes = 4;
     
-    // Calculate efficiency ratio
-    std::vector<double> efficiencyRatio(data.size(), 0.0);
-    for (int i = 0; i < data.size(); ++i) {
-        if (volatility[i] != 0) {
-            efficiencyRatio[i] = momentum[i] / volatility[i];
-        } else {
-            efficiencyRatio[i] = 0.0;
+    // Claimed without blocking, as in getOTTBatch
+    data = SeriesView(data.data(), data.size(), identify(data));
+    std::vector<std::unique_ptr<Claim>> claims;
+    std::vector<int> owned;
+    std::vector<size_t> owned_claims;
+    for (int length : lengths) {
+        IndicatorKey key = {IndicatorKind::VAR, data.id(), length, 0.0};
+        bool duplicate = false;
+        for (const auto& claim : claims) {
+            duplicate = duplicate || claim->key() == key;
+        }
+        if (duplicate) {
+            continue;
+        }
+        claims.emplace_back(new Claim(*this, key, false));
+        if (claims.back()->owned()) {
+            owned.push_back(length);
+            owned_claims.push_back(claims.size() - 1);
         }
     }
     
-    // Calculate alpha
-    double alpha = 2.0 / (length + 1.0);
-    
-    // Calculate VIDYA
-    for (int i = 0; i < data.size(); ++i) {
-        if (i == 0) {
-            result[i] = data[i];
-        } else if (length == 1) {
-            result[i] = data[i];
+    // Length 1 is the series itself; the rest share one efficiency ratio
+    std::vector<int> recurrent;
+    std::vector<std::vector<double>*> outputs;
+    std::vector<IndicatorTailLink> links;
+    std::vector<std::vector<double>> computed(owned.size());
+    for (size_t m = 0; m < owned.size(); ++m) {
+        IndicatorTailLink tail = tailLink(claims[owned_claims[m]]->key(), {data.id()}, data.size());
+        if (owned[m] == 1) {
+            if (tail.captures(data.size())) {
+                tail.store(tail.capture, {}, {});
+            }
+            computed[m].assign(data.begin(), data.end());
         } else {
-            result[i] = efficiencyRatio[i] * alpha * (data[i] - result[i-1]) + result[i-1];
+            computed[m].assign(data.size(), 0.0);
+            recurrent.push_back(owned[m]);
+            outputs.push_back(&computed[m]);
+            links.push_back(tail);
         }
     }
+    if (!recurrent.empty()) {
+        std::vector<double> ratio;
+        computeEfficiencyRatio(getAbsChange(data, 9), getSumAbsChanges(data, 9), ratio);
+        for (size_t first = 0; first < recurrent.size(); first += lanes) {
+            size_t active = std::min(lanes, recurrent.size() - first);
+            computeVARLanes<lanes>(data, ratio.data(), recurrent.data() + first, outputs.data() + first,
+                                   links.data() + first, active);
+        }
+    }
+    for (size_t m = 0; m < owned.size(); ++m) {
+        claims[owned_claims[m]]->publish(std::move(computed[m]));
+    }
     
-    // Cache and return
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        var_cache[length] = result;
-        return var_cache[length];
+    // Return in the order requested
+    std::vector<CachedSeries> results;
+    results.reserve(lengths.size());
+    for (int length : lengths) {
+        IndicatorKey key = {IndicatorKind::VAR, data.id(), length, 0.0};
+        for (const auto& claim : claims) {
+            if (claim->key() == key) {
+                results.push_back(claim->ready() ? claim->series() : getVAR(data, length));
+                break;
+            }
+        }
     }
+    return results;
 }
 
-const std::vector<double>& IndicatorCache::getOTT(const std::vector<double>& data, double multiplier) {
-    auto key = std::make_pair(data.size(), multiplier);
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = ott_cache.find(key);
-        if (it != ott_cache.end()) {
-            return it->second;
-        }
-    }
+// State of L OTT lanes between bars: the multiplier constants, the support line bounds and
+// stop (c, d, e) and the last two stop-line values the two-bar lag still has to emit
+template <size_t L>
+struct OttLanes {
+    double a[L], f[L], g[L], c[L], d[L], e[L], h_prev1[L], h_prev2[L];
     
-    std::vector<double> result(data.size(), 0.0);
+    static const size_t REGISTERS = 5;
+    
+    void save(size_t k, std::vector<double>& registers) const {
+        registers = {c[k], d[k], e[k], h_prev1[k], h_prev2[k]};
+    }
     
-    double a = multiplier / 100.0;
-    std::vector<double> c(data.size(), 0.0);
-    std::vector<double> d(data.size(), 0.0);
-    std::vector<double> e(data.size(), 0.0);
-    std::vector<double> h(data.size(), 0.0);
+    void load(size_t k, const std::vector<double>& registers) {
+        c[k] = registers[0];
+        d[k] = registers[1];
+        e[k] = registers[2];
+        h_prev1[k] = registers[3];
+        h_prev2[k] = registers[4];
+    }
+};
+
+// OTT recurrence for L multipliers at once over bars [begin, end), where bar `origin` (if
+// inside) starts the recurrence. Lane state lives in small fixed arrays and each step is a
+// per-lane select, so the lanes map onto SIMD registers and no per-bar scratch vectors are
+// needed. Each lane is bit-identical to running the recurrence on its own.
+template <size_t L>
+static void stepOTTLanes(const double* data, OttLanes<L>& state, std::vector<double>* const* outputs, size_t active_lanes,
+                         size_t origin, size_t begin, size_t end) {
+    OttLanes<L> s = state;
+    double* out[L];
+    for (size_t k = 0; k < active_lanes; ++k) {
+        out[k] = outputs[k]->data();
+    }
     
-    for (int i = 0; i < data.size(); ++i) {
-        double b = data[i] * a;
+    for (size_t i = begin; i < end; ++i) {
+        const double x = data[i];
+        double h[L];
         
-        if (i == 0) {
-            c[i] = data[i] - b;
-            d[i] = data[i] + b;
-            e[i] = 0.0;
-        } else {
-            c[i] = (data[i] - b) > c[i-1] || data[i] < c[i-1] ? (data[i] - b) : c[i-1];
-            d[i] = (data[i] + b) < d[i-1] || data[i] > d[i-1] ? (data[i] + b) : d[i-1];
-            e[i] = data[i] > e[i-1] ? c[i] : data[i] < e[i-1] ? d[i] : e[i-1];
+        for (size_t k = 0; k < L; ++k) {
+            double b = x * s.a[k];
+            double lower = x - b;
+            double upper = x + b;
+            
+            if (i == origin) {
+                s.c[k] = lower;
+                s.d[k] = upper;
+                s.e[k] = 0.0;
+            } else {
+                s.c[k] = lower > s.c[k] || x < s.c[k] ? lower : s.c[k];
+                s.d[k] = upper < s.d[k] || x > s.d[k] ? upper : s.d[k];
+                s.e[k] = x > s.e[k] ? s.c[k] : x < s.e[k] ? s.d[k] : s.e[k];
+            }
+            
+            h[k] = x > s.e[k] ? s.e[k] * s.f[k] : s.e[k] * s.g[k];
         }
         
-        double f = 1.0 + a / 2.0;
-        double g = 1.0 - a / 2.0;
-        
-        h[i] = data[i] > e[i] ? e[i] * f : e[i] * g;
-        
-        if (i >= 2) {
-            result[i] = h[i-2];
+        // OTT is the stop line lagged by two bars
+        for (size_t k = 0; k < active_lanes; ++k) {
+            out[k][i] = s.h_prev2[k];
+        }
+        for (size_t k = 0; k < L; ++k) {
+            s.h_prev2[k] = s.h_prev1[k];
+            s.h_prev1[k] = h[k];
+        }
+    }
+    state = s;
+}
+
+// Run up to L OTT lanes over a whole series, from bar 0 or from their tails, capturing the
+// tails where the run asks for them
+template <size_t L>
+static void computeOTTLanes(SeriesView data, const double* multipliers, std::vector<double>* const* outputs,
+                            const IndicatorTailLink* links, size_t active_lanes) {
+    const size_t n = data.size();
+    if (n == 0) {
+        return;
+    }
+    
+    OttLanes<L> state;
+    size_t origin = SIZE_MAX;
+    for (size_t k = 0; k < L; ++k) {
+        // Unused lanes repeat the last multiplier and are discarded
+        size_t lane = std::min(k, active_lanes - 1);
+        state.a[k] = multipliers[lane] / 100.0;
+        state.f[k] = 1.0 + state.a[k] / 2.0;
+        state.g[k] = 1.0 - state.a[k] / 2.0;
+        if (links[lane].warm()) {
+            state.load(k, links[lane].seed->registers);
         } else {
-            result[i] = 0.0;
+            state.c[k] = 0.0;
+            state.d[k] = 0.0;
+            state.e[k] = 0.0;
+            state.h_prev1[k] = 0.0;
+            state.h_prev2[k] = 0.0;
+            origin = 0;
         }
     }
     
-    // Cache and return
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        ott_cache[key] = result;
-        return ott_cache[key];
+    const size_t pause = links[0].pause(n);
+    stepOTTLanes<L>(data.data(), state, outputs, active_lanes, origin, 0, pause);
+    if (links[0].captures(n)) {
+        for (size_t k = 0; k < active_lanes; ++k) {
+            std::vector<double> registers;
+            state.save(k, registers);
+            links[k].store(links[k].capture, std::move(registers), {});
+        }
     }
+    stepOTTLanes<L>(data.data(), state, outputs, active_lanes, origin, pause, n);
 }
 
-const std::vector<double>& IndicatorCache::getAbsChange(const std::vector<double>& data, int period) {
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = abs_change_cache.find(period);
-        if (it != abs_change_cache.end()) {
-            return it->second;
-        }
+CachedSeries IndicatorCache::getOTT(SeriesView data, double multiplier) {
+    uint64_t input = identify(data);
+    IndicatorKey key = {IndicatorKind::OTT, input, 0, multiplier};
+    Claim claim(*this, key);
+    if (claim.ready()) {
+        return claim.series();
     }
+    IndicatorTailLink tail = tailLink(key, {input}, data.size());
     
     std::vector<double> result(data.size(), 0.0);
-    
-    for (int i = period; i < data.size(); ++i) {
-        result[i] = std::abs(data[i] - data[i - period]);
-    }
+    std::vector<double>* output = &result;
+    computeOTTLanes<1>(data, &multiplier, &output, &tail, 1);
     
     // Cache and return
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        abs_change_cache[period] = result;
-        return abs_change_cache[period];
-    }
+    return claim.publish(std::move(result));
 }
 
-const std::vector<double>& IndicatorCache::getSumAbsChanges(const std::vector<double>& data, int period) {
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = sum_abs_changes_cache.find(period);
-        if (it != sum_abs_changes_cache.end()) {
-            return it->second;
+std::vector<CachedSeries> IndicatorCache::getOTTBatch(SeriesView data, const std::vector<double>& multipliers) {
+    const size_t lanes = 4;
+    
+    // Claim every multiplier without blocking; only the ones this thread owns go through
+    // the kernel, and the ones another thread is computing are collected afterwards. Nothing
+    // is waited on while holding unpublished claims, so concurrent batches cannot deadlock.
+    uint64_t input = identify(data);
+    std::vector<std::unique_ptr<Claim>> claims;
+    std::vector<double> owned;
+    std::vector<size_t> owned_claims;
+    for (double multiplier : multipliers) {
+        IndicatorKey key = {IndicatorKind::OTT, input, 0, multiplier};
+        bool duplicate = false;
+        for (const auto& claim : claims) {
+            duplicate = duplicate || claim->key() == key;
+        }
+        if (duplicate) {
+            continue;
+        }
+        claims.emplace_back(new Claim(*this, key, false));
+        if (claims.back()->owned()) {
+            owned.push_back(multiplier);
+            owned_claims.push_back(claims.size() - 1);
         }
     }
     
-    std::vector<double> result(data.size(), 0.0);
-    std::vector<double> changes(data.size(), 0.0);
-    
-    for (size_t i = 1; i < data.size(); ++i) {
-        changes[i] = std::abs(data[i] - data[i - 1]);
+    std::vector<IndicatorTailLink> links;
+    for (size_t m = 0; m < owned.size(); ++m) {
+        links.push_back(tailLink(claims[owned_claims[m]]->key(), {input}, data.size()));
     }
-    
-    double sum = 0.0;
-    for (size_t i = 0; i < data.size(); ++i) {
-        sum += changes[i];
-        if (i >= period) {
-            sum -= changes[i - period];
+    std::vector<std::vector<double>> computed(owned.size(), std::vector<double>(data.size(), 0.0));
+    for (size_t first = 0; first < owned.size(); first += lanes) {
+        size_t active = std::min(lanes, owned.size() - first);
+        std::vector<double>* outputs[lanes];
+        for (size_t k = 0; k < active; ++k) {
+            outputs[k] = &computed[first + k];
         }
-        result[i] = sum;
+        computeOTTLanes<lanes>(data, owned.data() + first, outputs, links.data() + first, active);
+    }
+    for (size_t m = 0; m < owned.size(); ++m) {
+        claims[owned_claims[m]]->publish(std::move(computed[m]));
     }
     
-    // Cache and return
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        sum_abs_changes_cache[period] = result;
-        return sum_abs_changes_cache[period];
+    // Return in the order requested
+    std::vector<CachedSeries> results;
+    results.reserve(multipliers.size());
+    for (double multiplier : multipliers) {
+        IndicatorKey key = {IndicatorKind::OTT, input, 0, multiplier};
+        for (const auto& claim : claims) {
+            if (claim->key() == key) {
+                results.push_back(claim->ready() ? claim->series() : getOTT(SeriesView(data.data(), data.size(), input), multiplier));
+                break;
+            }
+        }
     }
+    return results;
 }
 
-const std::vector<double>& IndicatorCache::getHighest(const std::vector<double>& data, int period) {
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = highest_cache.find(period);
-        if (it != highest_cache.end()) {
-            return it->second;
-        }
+CachedSeries IndicatorCache::getAbsChange(SeriesView data, int period) {
+    uint64_t input = identify(data);
+    IndicatorKey key = {IndicatorKind::AbsChange, input, period, 0.0};
+    Claim claim(*this, key);
+    if (claim.ready()) {
+        return claim.series();
     }
+    IndicatorTailLink tail = tailLink(key, {input}, data.size());
     
-    std::vector<double> result(data.size(), 0.0);
-    
-    for (size_t i = 0; i < data.size(); ++i) {
-        double highest = std::numeric_limits<double>::lowest();
-        
-        for (int j = std::max(0, static_cast<int>(i) - period + 1); j <= i; ++j) {
-            highest = std::max(highest, data[j]);
+    // The first `period` bars of a window look back into the tail's history
+    TailInput in = tail.input(data);
+    const size_t total = in.h + data.size();
+    std::vector<double> result(total, 0.0);
+    if (period >= 0) {
+        const size_t lag = static_cast<size_t>(period);
+        const size_t begin = std::min(total, std::max(in.h, lag > in.base ? lag - in.base : 0));
+        SimdKernels::active().absChange(in.values, lag, begin, total, result.data());
+        if (tail.captures(data.size())) {
+            tail.store(tail.capture, {}, IndicatorTailLink::history(in, tail.capture, lag));
         }
-        
-        result[i] = highest;
+    } else if (tail.captures(data.size())) {
+        tail.store(tail.capture, {}, {});
     }
     
     // Cache and return
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        highest_cache[period] = result;
-        return highest_cache[period];
-    }
+    return claim.publish(dropHistory(std::move(result), in.h));
 }
 
-const std::vector<double>& IndicatorCache::getLowest(const std::vector<double>& data, int period) {
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = lowest_cache.find(period);
-        if (it != lowest_cache.end()) {
-            return it->second;
-        }
+CachedSeries IndicatorCache::getSumAbsChanges(SeriesView data, int period) {
+    uint64_t input = identify(data);
+    IndicatorKey key = {IndicatorKind::SumAbsChanges, input, period, 0.0};
+    Claim claim(*this, key);
+    if (claim.ready()) {
+        return claim.series();
     }
+    IndicatorTailLink tail = tailLink(key, {input}, data.size());
     
-    std::vector<double> result(data.size(), 0.0);
+    // The tail holds the running sum and the inputs of the changes still to leave the window
+    TailInput in = tail.input(data);
+    const size_t total = in.h + data.size();
+    std::vector<double> result(total, 0.0);
+    std::vector<double> changes(total, 0.0);
+    SimdKernels::active().absChange(in.values, 1, 1, total, changes.data());
     
-    for (size_t i = 0; i < data.size(); ++i) {
-        double lowest = std::numeric_limits<double>::max();
-        
-        for (int j = std::max(0, static_cast<int>(i) - period + 1); j <= i; ++j) {
-            lowest = std::min(lowest, data[j]);
+    // The running sum stays sequential so that every bar sees the same rounding
+    double sum = tail.warm() ? tail.seed->registers[0] : 0.0;
+    const size_t bounds[3] = {in.h, in.h + tail.pause(data.size()), total};
+    for (int part = 0; part < 2; ++part) {
+        if (part == 1 && tail.captures(data.size())) {
+            tail.store(tail.capture, {sum}, IndicatorTailLink::history(in, tail.capture, static_cast<size_t>(std::max(period, 0)) + 1));
+        }
+        for (size_t i = bounds[part]; i < bounds[part + 1]; ++i) {
+            sum += changes[i];
+            if (period >= 0 && in.base + i >= static_cast<size_t>(period)) {
+                sum -= changes[i - period];
+            }
+            result[i] = sum;
         }
-        
-        result[i] = lowest;
     }
     
     // Cache and return
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        lowest_cache[period] = result;
-        return lowest_cache[period];
+    return claim.publish(dropHistory(std::move(result), in.h));
+}
+
+CachedSeries IndicatorCache::getHighest(SeriesView data, int period) {
+    uint64_t input = identify(data);
+    IndicatorKey key = {IndicatorKind::Highest, input, period, 0.0};
+    Claim claim(*this, key);
+    if (claim.ready()) {
+        return claim.series();
     }
+    IndicatorTailLink tail = tailLink(key, {input}, data.size());
+    
+    std::vector<double> result = rollingExtremumOf(data, period, tail, std::greater<double>());
+    
+    // Cache and return
+    return claim.publish(std::move(result));
 }
 
-const std::vector<double>& IndicatorCache::getATR(const std::vector<double>& highs, 
-                                                const std::vector<double>& lows, 
-                                                const std::vector<double>& closes, 
-                                                int period) {
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = atr_cache.find(period);
-        if (it != atr_cache.end()) {
-            return it->second;
-        }
+CachedSeries IndicatorCache::getLowest(SeriesView data, int period) {
+    uint64_t input = identify(data);
+    IndicatorKey key = {IndicatorKind::Lowest, input, period, 0.0};
+    Claim claim(*this, key);
+    if (claim.ready()) {
+        return claim.series();
     }
+    IndicatorTailLink tail = tailLink(key, {input}, data.size());
     
-    std::vector<double> result(highs.size(), 0.0);
-    std::vector<double> tr(highs.size(), 0.0);
+    std::vector<double> result = rollingExtremumOf(data, period, tail, std::less<double>());
     
-    for (size_t i = 1; i < highs.size(); ++i) {
-        double tr1 = highs[i] - lows[i];
-        double tr2 = std::abs(highs[i] - closes[i-1]);
-        double tr3 = std::abs(lows[i] - closes[i-1]);
-        tr[i] = std::max({tr1, tr2, tr3});
+    // Cache and return
+    return claim.publish(std::move(result));
+}
+
+CachedSeries IndicatorCache::getATR(SeriesView highs, 
+                                    SeriesView lows, 
+                                    SeriesView closes, 
+                                    int period) {
+    uint64_t high_id = identify(highs);
+    uint64_t low_id = identify(lows);
+    uint64_t close_id = identify(closes);
+    uint64_t input = hashCombine64(hashCombine64(high_id, low_id), close_id);
+    IndicatorKey key = {IndicatorKind::ATR, input, period, 0.0};
+    Claim claim(*this, key);
+    if (claim.ready()) {
+        return claim.series();
     }
+    IndicatorTailLink tail = tailLink(key, {high_id, low_id, close_id}, highs.size());
+    
+    // A warm tail holds the last ATR and the last bar's high, low and close; a cold one every
+    // bar since bar 0, which are simply run through again
+    TailInput high_input = tail.input(highs, 0, 3);
+    TailInput low_input = tail.input(lows, 1, 3);
+    TailInput close_input = tail.input(closes, 2, 3);
+    const size_t h = close_input.h;
+    const size_t total = h + highs.size();
+    std::vector<double> result(total, 0.0);
+    std::vector<double> tr(total, 0.0);
+    SimdKernels::active().trueRange(high_input.values, low_input.values, close_input.values, 1, total, tr.data());
     
-    // Calculate first ATR as simple average of TR over period
-    if (highs.size() > period) {
+    size_t start = total;
+    bool started = true;
+    if (tail.warm()) {
+        result[h - 1] = tail.seed->registers[0];
+        start = h;
+    } else if (total > static_cast<size_t>(period)) {
+        // Calculate first ATR as simple average of TR over period
         double sum = 0;
         for (int i = 1; i <= period; ++i) {
             sum += tr[i];
         }
         result[period] = sum / period;
-        
-        // Calculate subsequent ATRs using smoothing formula
-        for (size_t i = period + 1; i < highs.size(); ++i) {
+        start = period + 1;
+    } else {
+        started = false;
+    }
+    
+    // Calculate subsequent ATRs using smoothing formula, with the tail captured midway
+    const size_t bounds[3] = {start, std::max(start, h + tail.pause(highs.size())), total};
+    for (int part = 0; part < 2; ++part) {
+        if (part == 1 && tail.captures(highs.size())) {
+            const size_t at = h + tail.capture;
+            if (started && at >= start) {
+                tail.store(tail.capture, {result[at - 1]},
+                           {high_input.values[at - 1], low_input.values[at - 1], close_input.values[at - 1]});
+            } else {
+                std::vector<double> history(high_input.values, high_input.values + at);
+                history.insert(history.end(), low_input.values, low_input.values + at);
+                history.insert(history.end(), close_input.values, close_input.values + at);
+                tail.store(tail.capture, {}, std::move(history));
+            }
+        }
+        for (size_t i = bounds[part]; i < bounds[part + 1]; ++i) {
             result[i] = (result[i-1] * (period - 1) + tr[i]) / period;
         }
     }
     
     // Cache and return
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        atr_cache[period] = result;
-        return atr_cache[period];
-    }
+    return claim.publish(dropHistory(std::move(result), h));
 }
 
-const std::vector<double>& IndicatorCache::getBBUpper(const std::vector<double>& data, int length, double multiplier) {
-    std::string cache_key = "bb_upper_" + std::to_string(length) + "_" + std::to_string(multiplier);
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = indicator_cache.find(cache_key);
-        if (it != indicator_cache.end()) {
-            return it->second;
+BollingerBands IndicatorCache::getBollingerBands(SeriesView data, int length, double multiplier) {
+    data = SeriesView(data.data(), data.size(), identify(data));
+    IndicatorKey key = {IndicatorKind::BollingerBands, data.id(), length, multiplier};
+    
+    // Both bands live in one buffer: upper in [0, n), lower in [n, 2n)
+    Claim claim(*this, key);
+    CachedSeries both;
+    if (claim.ready()) {
+        both = claim.series();
+    } else {
+        IndicatorTailLink tail = tailLink(key, {data.id()}, data.size());
+        
+        // Bands use VAR as the basis
+        CachedSeries basis = getVAR(data, length);
+        std::vector<double> result(2 * data.size(), 0.0);
+        double* upper = result.data();
+        double* lower = result.data() + data.size();
+        
+        // The deviation around basis b over a window of L values is
+        //   sum((x - b)^2) = Sxx - 2*b*Sx + L*b^2
+        // with Sx, Sxx kept as running compensated sums. The values are shifted by an anchor
+        // near the current price level to avoid cancellation, and the sums are rebuilt exactly
+        // at every re-anchor (once per window), which keeps the whole pass O(n). The tail
+        // holds the anchor, the sums, the next re-anchor bar and the window's last inputs.
+        if (length > 0) {
+            const size_t window = static_cast<size_t>(length);
+            TailInput in = tail.input(data);
+            const double* x = in.values;
+            const size_t h = in.h;
+            const size_t total = h + data.size();
+            double anchor = 0.0;
+            CompensatedSum sum_x;
+            CompensatedSum sum_xx;
+            size_t next_rebase = window;
+            if (tail.warm()) {
+                const std::vector<double>& registers = tail.seed->registers;
+                anchor = registers[0];
+                sum_x.sum = registers[1];
+                sum_x.compensation = registers[2];
+                sum_xx.sum = registers[3];
+                sum_xx.compensation = registers[4];
+                next_rebase = static_cast<size_t>(registers[5]);
+            }
+            
+            // The sums are sequential; the band math runs over blocks of them in the SIMD kernel.
+            // Indices are into x, whose entry i is absolute bar in.base + i.
+            const size_t block = 256;
+            double centered[block];
+            double window_x[block];
+            double window_xx[block];
+            const SimdKernelTable& kernels = SimdKernels::active();
+            
+            // The re-anchor bar is tracked as an index into x; the tail keeps it absolute
+            size_t rebase = next_rebase - in.base;
+            const size_t first = std::max(h, window > in.base ? window - in.base : 0);
+            const size_t bounds[3] = {first, std::max(first, h + tail.pause(data.size())), std::max(first, total)};
+            for (int part = 0; part < 2; ++part) {
+                if (part == 1 && tail.captures(data.size())) {
+                    tail.store(tail.capture,
+                               {anchor, sum_x.sum, sum_x.compensation, sum_xx.sum, sum_xx.compensation,
+                                static_cast<double>(in.base + rebase)},
+                               IndicatorTailLink::history(in, tail.capture, window));
+                }
+                for (size_t start = bounds[part]; start < bounds[part + 1]; start += block) {
+                    const size_t stop = std::min(start + block, bounds[part + 1]);
+                    for (size_t i = start; i < stop; ++i) {
+                        if (i == rebase) {
+                            anchor = basis[i - h];
+                            sum_x = CompensatedSum();
+                            sum_xx = CompensatedSum();
+                            for (size_t j = i - window + 1; j <= i; ++j) {
+                                double y = x[j] - anchor;
+                                sum_x.add(y);
+                                sum_xx.add(y * y);
+                            }
+                            rebase = i + window;
+                        } else {
+                            double y_in = x[i] - anchor;
+                            double y_out = x[i - window] - anchor;
+                            sum_x.add(y_in);
+                            sum_x.add(-y_out);
+                            sum_xx.add(y_in * y_in);
+                            sum_xx.add(-y_out * y_out);
+                        }
+                        centered[i - start] = basis[i - h] - anchor;
+                        window_x[i - start] = sum_x.value();
+                        window_xx[i - start] = sum_xx.value();
+                    }
+                    kernels.bollingerBands(basis.data() + (start - h), centered, window_x, window_xx, length, multiplier,
+                                           0, stop - start, upper + (start - h), lower + (start - h));
+                }
+            }
+        } else if (tail.captures(data.size())) {
+            tail.store(tail.capture, {}, {});
         }
+        tail.derive(key.id(), 1);
+        tail.derive(key.id(), 2);
+        both = claim.publish(std::move(result));
     }
     
-    // Calculate BB Upper using VAR as the basis
-    const auto& basis = getVAR(data, length);
-    std::vector<double> result(data.size(), 0.0);
+    // Each band is a derived series of its own
+    const size_t n = data.size();
+    BollingerBands bands;
+    bands.upper = CachedSeries(std::shared_ptr<const double>(both.storage(), both.data()), n, hashCombine64(key.id(), 1));
+    bands.lower = CachedSeries(std::shared_ptr<const double>(both.storage(), both.data() + n), n, hashCombine64(key.id(), 2));
+    return bands;
+}
+
+CachedSeries IndicatorCache::getBBUpper(SeriesView data, int length, double multiplier) {
+    return getBollingerBands(data, length, multiplier).upper;
+}
+
+CachedSeries IndicatorCache::getBBLower(SeriesView data, int length, double multiplier) {
+    return getBollingerBands(data, length, multiplier).lower;
+}
+
+uint64_t IndicatorKey::id() const {
+    uint64_t multiplier_bits;
+    std::memcpy(&multiplier_bits, &multiplier, sizeof(multiplier_bits));
+    uint64_t h = hashCombine64(static_cast<uint64_t>(kind) + 1, input);
+    h = hashCombine64(h, static_cast<uint64_t>(static_cast<int64_t>(length)));
+    return hashCombine64(h, multiplier_bits);
+}
+
+uint64_t IndicatorCache::identify(SeriesView data) {
+    // Every view handed in by its owner carries its identity. A scratch view (id 0) is not
+    // meant as an input; should one arrive, it is identified by its contents rather than its
+    // address, since a freed buffer's address can come back with other contents.
+    return data.id() != 0 ? data.id() : seriesContentId(data.data(), data.size());
+}
+
+IndicatorTailLink IndicatorCache::tailLink(const IndicatorKey& key, std::initializer_list<uint64_t> inputs, std::size_t length) {
+    IndicatorTailLink link;
+    if (!tails) {
+        return link;
+    }
+    link.first_bar = tails->firstBar();
+
+    // The recipe names the inputs the way the key's input combines their ids
+    uint64_t input = 0;
+    bool first = true;
+    for (uint64_t id : inputs) {
+        uint64_t recipe = 0;
+        if (!tails->recipeOf(id, recipe)) {
+            tails->markIncomplete();
+            return link;
+        }
+        input = first ? recipe : hashCombine64(input, recipe);
+        first = false;
+    }
+    IndicatorKey named = key;
+    named.input = input;
+    link.recipe = named.id();
+    tails->addRecipe(key.id(), link.recipe);
+
+    // A window that does not start at bar 0 is only right if every series continues exactly
+    // where the previous run left it
+    if (link.first_bar > 0) {
+        link.seed = tails->seed(link.recipe);
+        if (link.seed == nullptr || link.seed->bar != link.first_bar) {
+            link.seed = nullptr;
+            tails->markIncomplete();
+        }
+    }
+    if (tails->captureIndex() <= length) {
+        link.capture = tails->captureIndex();
+    } else {
+        tails->markIncomplete();
+    }
+    link.tails = tails.get();
+    return link;
+}
+
+IndicatorCache::IndicatorCache(std::size_t memory_budget_bytes)
+    : table(nullptr), cache_id(next_cache_id.fetch_add(1)), budget_bytes(memory_budget_bytes), resident_bytes(0),
+      peak_bytes(0), access_clock(0), misses(0), evictions(0), next_eviction_scan(0), store_loads(0), store_saves(0) {}
+
+IndicatorCache::~IndicatorCache() = default;
+
+IndicatorCache::Entry* IndicatorCache::findEntry(const IndicatorKey& key) const {
+    const Table* current = table.load(std::memory_order_acquire);
+    return current != nullptr ? current->find(key, key.id()) : nullptr;
+}
+
+IndicatorCache::Entry* IndicatorCache::insertEntry(const IndicatorKey& key, bool& created) {
+    std::lock_guard<std::mutex> lock(insert_mutex);
+    created = false;
+    const uint64_t hash = key.id();
     
-    // Calculate standard deviation
-    for (size_t i = length; i < data.size(); ++i) {
-        double sum_sq = 0.0;
-        for (int j = i - length + 1; j <= i; ++j) {
-            sum_sq += (data[j] - basis[i]) * (data[j] - basis[i]);
+    // Another thread may have inserted it since the lock-free lookup
+    Table* current = table.load(std::memory_order_relaxed);
+    if (current != nullptr) {
+        if (Entry* existing = current->find(key, hash)) {
+            return existing;
         }
-        double stdev = std::sqrt(sum_sq / length);
-        result[i] = basis[i] + (multiplier * stdev);
     }
     
-    // Cache and return
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        indicator_cache[cache_key] = result;
-        return indicator_cache[cache_key];
+    // Keep the load factor at or below one half. The old table stays alive (readers may
+    // still be probing it) and simply stops receiving new entries.
+    if (current == nullptr || 2 * (current->used + 1) > current->mask + 1) {
+        std::size_t capacity = current != nullptr ? 2 * (current->mask + 1) : 64;
+        std::unique_ptr<Table> grown(new Table(capacity));
+        for (const auto& entry : entries) {
+            grown->insert(entry.get(), entry->key.id());
+        }
+        current = grown.get();
+        tables.push_back(std::move(grown));
+        table.store(current, std::memory_order_release);
     }
+    
+    entries.emplace_back(new Entry(key));
+    current->insert(entries.back().get(), hash);
+    created = true;
+    return entries.back().get();
 }
 
-const std::vector<double>& IndicatorCache::getBBLower(const std::vector<double>& data, int length, double multiplier) {
-    std::string cache_key = "bb_lower_" + std::to_string(length) + "_" + std::to_string(multiplier);
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        auto it = indicator_cache.find(cache_key);
-        if (it != indicator_cache.end()) {
-            return it->second;
+IndicatorCache::Readers& IndicatorCache::localReaders() {
+    if (readers_cache.cache_id == cache_id) {
+        return *static_cast<Readers*>(readers_cache.readers);
+    }
+    
+    std::lock_guard<std::mutex> lock(readers_mutex);
+    std::thread::id self = std::this_thread::get_id();
+    Readers* mine = nullptr;
+    for (const auto& existing : readers) {
+        if (existing->owner == self) {
+            mine = existing.get();
         }
     }
+    if (mine == nullptr) {
+        readers.push_back(std::make_unique<Readers>());
+        mine = readers.back().get();
+        mine->owner = self;
+    }
+    readers_cache.cache_id = cache_id;
+    readers_cache.readers = mine;
+    return *mine;
+}
+
+bool IndicatorCache::readHandle(Entry* entry, std::shared_ptr<const double>& values) {
+    Readers& mine = localReaders();
+    std::lock_guard<std::mutex> lock(mine.mutex);
+    if (entry->state.load(std::memory_order_acquire) != Entry::Ready) {
+        return false;
+    }
+    std::shared_ptr<const double>& handle = mine.handles[entry];
+    if (!handle) {
+        // The thread's first read of this series: the only copy of the entry's own reference
+        auto reference = std::make_shared<std::shared_ptr<const double>>(entry->values);
+        handle = std::shared_ptr<const double>(reference, reference->get());
+    }
+    values = handle;
+    mine.hits.store(mine.hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void IndicatorCache::countMiss() {
+    misses.fetch_add(1, std::memory_order_relaxed);
+    access_clock.fetch_add(1, std::memory_order_relaxed);
+}
+
+void IndicatorCache::addResident(std::size_t bytes) {
+    std::size_t resident = resident_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    std::size_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (resident > peak && !peak_bytes.compare_exchange_weak(peak, resident, std::memory_order_relaxed)) {
+    }
+    if (budget_bytes > 0 && resident > budget_bytes && resident >= next_eviction_scan.load(std::memory_order_relaxed)) {
+        evict();
+    }
+}
+
+void IndicatorCache::evict() {
+    std::lock_guard<std::mutex> lock(insert_mutex);
+    if (resident_bytes.load(std::memory_order_relaxed) <= budget_bytes) {
+        return;
+    }
     
-    // Calculate BB Lower using VAR as the basis
-    const auto& basis = getVAR(data, length);
-    std::vector<double> result(data.size(), 0.0);
+    // With every thread's Readers locked nobody is copying a handle, so the use counts below
+    // only fall. A series is releasable when the references to its buffer are the entry's own
+    // and one per thread handle, and no thread handle has been copied out.
+    std::lock_guard<std::mutex> readers_lock(readers_mutex);
+    std::vector<std::unique_lock<std::mutex>> reader_locks;
+    for (const auto& thread_readers : readers) {
+        reader_locks.emplace_back(thread_readers->mutex);
+    }
+    auto releasable = [this](const Entry& entry) {
+        long handles = 0;
+        for (const auto& thread_readers : readers) {
+            auto it = thread_readers->handles.find(&entry);
+            if (it != thread_readers->handles.end()) {
+                if (it->second.use_count() > 1) {
+                    return false;
+                }
+                ++handles;
+            }
+        }
+        return entry.values.use_count() == 1 + handles;
+    };
     
-    // Calculate standard deviation
-    for (size_t i = length; i < data.size(); ++i) {
-        double sum_sq = 0.0;
-        for (int j = i - length + 1; j <= i; ++j) {
-            sum_sq += (data[j] - basis[i]) * (data[j] - basis[i]);
+    // Candidates are ready series that nobody outside the cache holds a handle to; series in
+    // use by a backtest are pinned by their handles and never evicted
+    struct Candidate {
+        Entry* entry;
+        double score;
+    };
+    std::vector<Candidate> candidates;
+    const uint64_t now = access_clock.load(std::memory_order_relaxed);
+    for (const auto& entry : entries) {
+        if (entry->state.load(std::memory_order_acquire) != Entry::Ready) {
+            continue;
+        }
+        // Only this thread takes entries out of Ready, so `values` is stable here
+        if (releasable(*entry)) {
+            // Size-aware LRU: older and larger series go first
+            double age = static_cast<double>(now - std::min(now, entry->last_used.load(std::memory_order_relaxed))) + 1.0;
+            candidates.push_back({entry.get(), age * static_cast<double>(entry->length.load(std::memory_order_relaxed))});
         }
-        double stdev = std::sqrt(sum_sq / length);
-        result[i] = basis[i] - (multiplier * stdev);
     }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.score > b.score;
+    });
     
-    // Cache and return
+    for (const auto& candidate : candidates) {
+        if (resident_bytes.load(std::memory_order_relaxed) <= budget_bytes) {
+            break;
+        }
+        // Drop the thread handles with the entry's reference; readers next see it Evicted
+        Entry* entry = candidate.entry;
+        for (const auto& thread_readers : readers) {
+            thread_readers->handles.erase(entry);
+        }
+        entry->values.reset();
+        entry->state.store(Entry::Evicted, std::memory_order_release);
+        std::size_t bytes = entry->length.load(std::memory_order_relaxed) * sizeof(double);
+        resident_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    // Whatever is still over budget is pinned; scanning again on every insert would only find
+    // the same handles, so wait until the cache has grown by a useful amount
+    std::size_t resident = resident_bytes.load(std::memory_order_relaxed);
+    next_eviction_scan.store(resident > budget_bytes ? resident + std::max<std::size_t>(budget_bytes / 8, 1) : 0,
+                             std::memory_order_relaxed);
+}
+
+IndicatorCache::Stats IndicatorCache::getStats() const {
+    Stats stats;
+    stats.hits = 0;
     {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        indicator_cache[cache_key] = result;
-        return indicator_cache[cache_key];
+        std::lock_guard<std::mutex> lock(readers_mutex);
+        for (const auto& thread_readers : readers) {
+            stats.hits += thread_readers->hits.load(std::memory_order_relaxed);
+        }
     }
+    stats.misses = misses.load(std::memory_order_relaxed);
+    stats.evictions = evictions.load(std::memory_order_relaxed);
+    stats.store_loads = store_loads.load(std::memory_order_relaxed);
+    stats.store_saves = store_saves.load(std::memory_order_relaxed);
+    stats.resident_bytes = resident_bytes.load(std::memory_order_relaxed);
+    stats.peak_bytes = peak_bytes.load(std::memory_order_relaxed);
+    stats.budget_bytes = budget_bytes;
+    return stats;
 }
 
 void IndicatorCache::clear() {
-    std::lock_guard<std::mutex> lock(cache_mutex);
-    var_cache.clear();
-    ott_cache.clear();
-    indicator_cache.clear();
-    abs_change_cache.clear();
-    sum_abs_changes_cache.clear();
-    highest_cache.clear();
-    lowest_cache.clear();
-    atr_cache.clear();
-}
\ No newline at end of file
+    std::lock_guard<std::mutex> lock(insert_mutex);
+    {
+        std::lock_guard<std::mutex> readers_lock(readers_mutex);
+        for (const auto& thread_readers : readers) {
+            std::lock_guard<std::mutex> reader_lock(thread_readers->mutex);
+            thread_readers->handles.clear();
+        }
+    }
+    table.store(nullptr, std::memory_order_release);
+    tables.clear();
+    entries.clear();
+    resident_bytes.store(0, std::memory_order_relaxed);
+    next_eviction_scan.store(0, std::memory_order_relaxed);
+}
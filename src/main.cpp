@@ -7,6 +7,11 @@
 #include "indicators.h"
 #include "backtester.h"
 #include "optimizers.h"
+#include "price_series.h"
+#include "thread_pool.h"
+#include "indicator_store.h"
+#include "numa_topology.h"
+#include "simd_kernels.h"
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
@@ -20,6 +25,13 @@ int main(int argc, char* argv[]) {
         std::cout << "  --no-tp                 Disable take profit" << std::endl;
         std::cout << "  --pyramiding            Enable pyramiding" << std::endl;
         std::cout << "  --exclude-sl            Exclude stop loss trades from win rate calculation" << std::endl;
+        std::cout << "  --no-bar-cache          Always parse the CSV instead of using <csv_file>.bars" << std::endl;
+        std::cout << "  --cache-mb=N            Memory budget for cached indicators in MB (default: unlimited)" << std::endl;
+        std::cout << "  --numa                  Replicate data and caches per NUMA node (needs libnuma)" << std::endl;
+        std::cout << "  --simd=LEVEL            Indicator kernels: scalar, avx2 or avx512 (default: best supported)" << std::endl;
+        std::cout << "  --indicator-store=DIR   Share computed indicators between runs through files in DIR" << std::endl;
+        std::cout << "  --state-dir=DIR         Save run state per strategy and continue from it on appended bars" << std::endl;
+        std::cout << "  --walk-forward=IN,OUT[,STEP]  Walk forward over windows of IN in-sample and OUT out-of-sample bars" << std::endl;
         std::cout << "Available strategies: OTT, TOTT, OTT_CHANNEL, RISOTTO, SOTT, HOTT-LOTT, ROTT, FT, RTR, MOTT, BOOTS" << std::endl;
         std::cout << "Example: " << argv[0] << " data.csv --strategies=OTT,SOTT,MOTT --threads=8" << std::endl;
         return 1;
@@ -34,6 +46,12 @@ int main(int argc, char* argv[]) {
     bool use_tp = true;
     bool pyramiding = false;
     bool exclude_sl_from_winrate = false;
+    bool use_bar_cache = true;
+    std::size_t cache_mb = 0;
+    bool use_numa = false;
+    std::string state_dir;
+    std::string store_dir;
+    WalkForwardConfig walk_forward;
     
     // Parse command line arguments
     for (int i = 2; i < argc; i++) {
@@ -71,18 +89,61 @@ int main(int argc, char* argv[]) {
         else if (arg == "--exclude-sl") {
             exclude_sl_from_winrate = true;
         }
+        else if (arg == "--no-bar-cache") {
+            use_bar_cache = false;
+        }
+        else if (arg.find("--cache-mb=") == 0) {
+            cache_mb = std::stoul(arg.substr(11));
+        }
+        else if (arg == "--numa") {
+            use_numa = true;
+        }
+        else if (arg.find("--simd=") == 0) {
+            SimdLevel level;
+            if (!SimdKernels::levelFromName(arg.c_str() + 7, level) || !SimdKernels::setLevel(level)) {
+                std::cerr << "SIMD level " << arg.substr(7) << " is not available, using "
+                          << SimdKernels::levelName(SimdKernels::detect()) << std::endl;
+            }
+        }
+        else if (arg.find("--indicator-store=") == 0) {
+            store_dir = arg.substr(18);
+        }
+        else if (arg.find("--state-dir=") == 0) {
+            state_dir = arg.substr(12);
+        }
+        else if (arg.find("--walk-forward=") == 0) {
+            // In-sample, out-of-sample and optional step lengths in bars
+            std::vector<std::size_t> lengths;
+            std::stringstream ss(arg.substr(15));
+            std::string length;
+            while (std::getline(ss, length, ',')) {
+                lengths.push_back(std::stoul(length));
+            }
+            if (lengths.size() < 2 || lengths.size() > 3 || lengths[0] == 0 || lengths[1] == 0) {
+                std::cerr << "Invalid walk-forward layout " << arg.substr(15) << ", expected IN,OUT[,STEP]" << std::endl;
+                return 1;
+            }
+            walk_forward.in_sample_bars = lengths[0];
+            walk_forward.out_of_sample_bars = lengths[1];
+            walk_forward.step_bars = lengths.size() == 3 ? lengths[2] : 0;
+        }
     }
     
+    // Every strategy schedules its work on one shared pool of this size
+    ThreadPool::setSharedSize(num_threads);
+    
     // Load price data
     std::cout << "Loading data from " << filename << "..." << std::endl;
-    auto bars = StrategyBacktester::loadCSV(filename);
+    auto prices = PriceSeries::load(filename, use_bar_cache);
     
-    if (bars.empty()) {
+    if (!prices || prices->empty()) {
         std::cerr << "Failed to load data or file is empty." << std::endl;
         return 1;
     }
     
-    std::cout << "Loaded " << bars.size() << " bars from " << bars.front().date << " to " << bars.back().date << std::endl;
+    std::cout << "Loaded " << prices->size() << " bars from " << prices->date(0)
+              << " to " << prices->date(prices->size() - 1) << std::endl;
+    std::cout << "Indicator kernels: " << SimdKernels::levelName(SimdKernels::active().level) << std::endl;
     
     // Define SL/TP ranges
     std::vector<double> sl_percents;
@@ -97,7 +158,7 @@ int main(int argc, char* argv[]) {
     
     // Create and run multi-strategy optimizer
     MultiStrategyOptimizer optimizer(
-        bars,
+        prices,
         strategies,
         sl_percents,
         tp_percents,
@@ -107,11 +168,62 @@ int main(int argc, char* argv[]) {
         10000.0, // initial capital
         min_trades,
         min_win_rate,
-        exclude_sl_from_winrate,
-        num_threads
+        exclude_sl_from_winrate
     );
     
+    // Optional disk tier shared with other runs and processes on this host
+    std::shared_ptr<IndicatorStore> store;
+    if (!store_dir.empty()) {
+        store = IndicatorStore::open(store_dir);
+    }
+    
+    auto cache = std::make_shared<IndicatorCache>(cache_mb * 1024 * 1024);
+    cache->setStore(store);
+    optimizer.setIndicatorCache(cache);
+    if (!state_dir.empty()) {
+        optimizer.setStateDirectory(state_dir);
+    }
+    if (walk_forward.in_sample_bars > 0) {
+        optimizer.setWalkForward(walk_forward);
+    }
+    
+    // NUMA mode: a price replica, cache shard and pinned worker pool per node
+    std::shared_ptr<NumaShards> numa_shards;
+    if (use_numa) {
+        numa_shards = NumaShards::create(*prices, num_threads, cache_mb * 1024 * 1024);
+        if (numa_shards) {
+            std::cout << "NUMA mode: " << numa_shards->size() << " nodes" << std::endl;
+            for (std::size_t s = 0; s < numa_shards->size(); ++s) {
+                numa_shards->shard(s).cache->setStore(store);
+            }
+            optimizer.setNumaShards(numa_shards);
+        } else {
+            std::cout << "NUMA mode unavailable (single node or no libnuma), continuing without it" << std::endl;
+        }
+    }
+    
     optimizer.optimizeAll();
     
+    // Report how the indicator cache behaved so the budget can be sized. In NUMA mode the
+    // walk-forward and incremental paths still read the shared cache, so it counts too.
+    IndicatorCache::Stats stats = cache->getStats();
+    if (numa_shards) {
+        stats += numa_shards->cacheStats();
+    }
+    uint64_t lookups = stats.hits + stats.misses;
+    std::cout << "Indicator cache: " << stats.hits << " hits, " << stats.misses << " misses ("
+              << (lookups > 0 ? 100.0 * stats.hits / lookups : 0.0) << "% hit rate), "
+              << stats.evictions << " evictions" << std::endl;
+    if (store) {
+        std::cout << "Indicator store: " << stats.store_loads << " series loaded, " << stats.store_saves
+                  << " written" << std::endl;
+    }
+    std::cout << "Indicator cache memory: " << stats.resident_bytes / (1024.0 * 1024.0) << " MB resident, "
+              << stats.peak_bytes / (1024.0 * 1024.0) << " MB peak";
+    if (stats.budget_bytes > 0) {
+        std::cout << ", " << stats.budget_bytes / (1024 * 1024) << " MB budget";
+    }
+    std::cout << std::endl;
+    
     return 0;
 }
\ No newline at end of file
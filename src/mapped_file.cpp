@@ -0,0 +1,117 @@
+#include "mapped_file.h"
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TSO_HAVE_MMAP 1
+#endif
+
+MappedFile::MappedFile()
+    : data_ptr(nullptr), data_size(0), is_open(false), is_mapped(false) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+#ifdef TSO_HAVE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    data_size = static_cast<std::size_t>(st.st_size);
+    if (data_size > 0) {
+        void* addr = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            data_size = 0;
+            return false;
+        }
+        // Parsers walk the file front to back exactly once
+        madvise(addr, data_size, MADV_SEQUENTIAL);
+        data_ptr = static_cast<const char*>(addr);
+        is_mapped = true;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    is_open = true;
+    return true;
+#else
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    fallback_buffer = contents.str();
+    data_ptr = fallback_buffer.data();
+    data_size = fallback_buffer.size();
+    is_open = true;
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef TSO_HAVE_MMAP
+    if (is_mapped) {
+        munmap(const_cast<char*>(data_ptr), data_size);
+    }
+#endif
+    fallback_buffer.clear();
+    fallback_buffer.shrink_to_fit();
+    data_ptr = nullptr;
+    data_size = 0;
+    is_open = false;
+    is_mapped = false;
+}
+
+std::string temporaryPath(const std::string& path) {
+    std::random_device entropy;
+    const uint64_t tag = (static_cast<uint64_t>(entropy()) << 32) ^ entropy();
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), ".tmp.%016llx", static_cast<unsigned long long>(tag));
+    return path + suffix;
+}
+
+bool writeFileAtomically(const std::string& path, const std::function<void(std::ostream&)>& writer) {
+    const std::string temp_path = temporaryPath(path);
+    bool written;
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        writer(out);
+        out.close();
+        written = !out.fail();
+    }
+
+    std::error_code ec;
+    if (written) {
+        std::filesystem::rename(temp_path, path, ec);
+    }
+    if (!written || ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
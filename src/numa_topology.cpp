@@ -0,0 +1,165 @@
+#include "numa_topology.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+bool NumaTopology::available() {
+#ifdef HAVE_LIBNUMA
+    return numa_available() >= 0;
+#else
+    return false;
+#endif
+}
+
+int NumaTopology::nodeCount() {
+#ifdef HAVE_LIBNUMA
+    if (available()) {
+        return std::max(numa_num_configured_nodes(), 1);
+    }
+#endif
+    return 1;
+}
+
+std::vector<int> NumaTopology::cpuNodes() {
+    std::vector<int> nodes;
+#ifdef HAVE_LIBNUMA
+    if (available()) {
+        struct bitmask* cpus = numa_allocate_cpumask();
+        for (int node = 0; node <= numa_max_node(); ++node) {
+            if (numa_bitmask_isbitset(numa_all_nodes_ptr, node) && numa_node_to_cpus(node, cpus) == 0 &&
+                numa_bitmask_weight(cpus) > 0) {
+                nodes.push_back(node);
+            }
+        }
+        numa_free_cpumask(cpus);
+    }
+#endif
+    if (nodes.empty()) {
+        nodes.push_back(0);
+    }
+    return nodes;
+}
+
+bool NumaTopology::bindCurrentThread(int node) {
+#ifdef HAVE_LIBNUMA
+    if (available() && numa_run_on_node(node) == 0) {
+        numa_set_preferred(node);
+        return true;
+    }
+#endif
+    (void)node;
+    return false;
+}
+
+void* NumaTopology::allocate(std::size_t bytes, int node) {
+#ifdef HAVE_LIBNUMA
+    if (node >= 0 && available()) {
+        return numa_alloc_onnode(bytes, node);
+    }
+#endif
+    return ::operator new(bytes, std::align_val_t(PriceSeries::COLUMN_ALIGNMENT), std::nothrow);
+}
+
+void NumaTopology::release(void* memory, std::size_t bytes, int node) {
+    if (memory == nullptr) {
+        return;
+    }
+#ifdef HAVE_LIBNUMA
+    if (node >= 0 && available()) {
+        numa_free(memory, bytes);
+        return;
+    }
+#endif
+    (void)bytes;
+    (void)node;
+    ::operator delete(memory, std::align_val_t(PriceSeries::COLUMN_ALIGNMENT));
+}
+
+// Copy the price columns into one block on `node`, keeping the column ids so cache keys of
+// the replica match those of the original
+static std::shared_ptr<const PriceSeries> replicateOnNode(const PriceSeries& prices, int node) {
+    const std::size_t n = prices.size();
+    const std::size_t alignment = PriceSeries::COLUMN_ALIGNMENT;
+    const std::size_t column_bytes = (n * sizeof(double) + alignment - 1) / alignment * alignment;
+    const std::size_t total_bytes = std::max<std::size_t>(column_bytes * 6, alignment);
+
+    void* block = NumaTopology::allocate(total_bytes, node);
+    if (block == nullptr) {
+        std::cerr << "Failed to allocate price replica on NUMA node " << node << std::endl;
+        return nullptr;
+    }
+    std::shared_ptr<void> owner(block, [total_bytes, node](void* p) { NumaTopology::release(p, total_bytes, node); });
+
+    SeriesView columns[5] = {prices.opens(), prices.highs(), prices.lows(), prices.closes(), prices.volumes()};
+    uint64_t column_ids[5];
+    char* base = static_cast<char*>(block);
+    std::memcpy(base, prices.timestamps(), n * sizeof(int64_t));
+    for (int c = 0; c < 5; ++c) {
+        std::memcpy(base + column_bytes * (c + 1), columns[c].data(), n * sizeof(double));
+        column_ids[c] = columns[c].id();
+    }
+
+    return PriceSeries::fromMapped(owner,
+                                   reinterpret_cast<const int64_t*>(base),
+                                   reinterpret_cast<const double*>(base + column_bytes),
+                                   reinterpret_cast<const double*>(base + column_bytes * 2),
+                                   reinterpret_cast<const double*>(base + column_bytes * 3),
+                                   reinterpret_cast<const double*>(base + column_bytes * 4),
+                                   reinterpret_cast<const double*>(base + column_bytes * 5),
+                                   n, prices.checksum(), column_ids, prices.hasTimeOfDay());
+}
+
+std::shared_ptr<NumaShards> NumaShards::create(const PriceSeries& prices, int num_threads,
+                                               std::size_t cache_budget_bytes, int emulated_nodes) {
+    // Emulated nodes have no id: unpinned workers and heap replicas
+    std::vector<int> node_ids = emulated_nodes > 0 ? std::vector<int>(emulated_nodes, -1) : NumaTopology::cpuNodes();
+    const int nodes = static_cast<int>(node_ids.size());
+    if (nodes < 2) {
+        return nullptr;
+    }
+
+    std::shared_ptr<NumaShards> result(new NumaShards());
+    num_threads = std::max(num_threads, nodes);
+    for (int s = 0; s < nodes; ++s) {
+        Shard shard;
+        shard.node = node_ids[s];
+        shard.prices = replicateOnNode(prices, shard.node);
+        if (!shard.prices) {
+            return nullptr;
+        }
+        shard.cache = std::make_shared<IndicatorCache>(cache_budget_bytes / nodes);
+
+        // Spread the threads evenly, the remainder going to the first nodes
+        int threads = num_threads / nodes + (s < num_threads % nodes ? 1 : 0);
+        shard.pool = std::make_unique<ThreadPool>(threads, shard.node);
+        result->shards.push_back(std::move(shard));
+    }
+    return result;
+}
+
+const NumaShards::Shard* NumaShards::current() const {
+    std::size_t index = currentIndex();
+    return index < shards.size() ? &shards[index] : nullptr;
+}
+
+std::size_t NumaShards::currentIndex() const {
+    for (std::size_t s = 0; s < shards.size(); ++s) {
+        if (shards[s].pool->ownsCurrentThread()) {
+            return s;
+        }
+    }
+    return shards.size();
+}
+
+IndicatorCache::Stats NumaShards::cacheStats() const {
+    IndicatorCache::Stats total = {};
+    for (const auto& shard : shards) {
+        total += shard.cache->getStats();
+    }
+    return total;
+}
@@ -0,0 +1,128 @@
+#include "optimizers.h"
+#include "hashing.h"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+bool StrategyOptimizer::continueRun(RunState& state, uint64_t grid, std::vector<BacktestResult>& results) {
+    const std::size_t n = prices->size();
+    const std::size_t first_bar = static_cast<std::size_t>(state.capture_bar);
+    const std::size_t capture_bar = n > RunState::OVERLAP_BARS ? n - RunState::OVERLAP_BARS : 0;
+    if (state.bars == 0) {
+        const LaneState fresh = {MetricsAccumulator(initial_capital), std::vector<OpenPosition>(), 0};
+        state.lanes.assign(signalVariants(), std::vector<LaneState>(sl_percents.size() * tp_percents.size(), fresh));
+        state.tails.clear();
+    }
+
+    // Every series of the window continues from the tail the last run left at its first bar
+    std::shared_ptr<const PriceSeries> window = RunState::window(prices, first_bar);
+    auto tails = std::make_shared<IndicatorTails>(first_bar, capture_bar - first_bar, std::move(state.tails));
+    tails->addColumns(*window);
+    auto window_cache = std::make_shared<IndicatorCache>();
+    window_cache->setTails(tails);
+
+    // The strategy's planIndicators() and variantSignals() read the window through the usual
+    // members for the length of the run; NUMA shards hold the full series, so they sit out
+    std::shared_ptr<const PriceSeries> full_prices = prices;
+    std::shared_ptr<IndicatorCache> full_cache = cache;
+    std::shared_ptr<NumaShards> shards = numa_shards;
+    prices = window;
+    closes = window->closes();
+    highs = window->highs();
+    lows = window->lows();
+    opens = window->opens();
+    cache = window_cache;
+    numa_shards.reset();
+
+    precomputeIndicators();
+    TradeSimulator simulator(*window, initial_capital, exclude_sl_from_winrate);
+    IncrementalRunEngine engine(simulator, sl_percents, tp_percents, use_sl, use_tp, pyramiding);
+    BacktestFilter filter;
+    filter.min_trades = min_trades;
+    filter.min_win_rate = min_win_rate;
+    bool continued = engine.run(state.lanes, first_bar,
+                                [this](std::size_t variant) { return variantKey(variant); },
+                                [this](std::size_t variant, std::vector<int>& dir) { return variantSignals(variant, dir); },
+                                filter, results);
+
+    prices = full_prices;
+    closes = prices->closes();
+    highs = prices->highs();
+    lows = prices->lows();
+    opens = prices->opens();
+    cache = full_cache;
+    numa_shards = shards;
+
+    state.bars = n;
+    state.capture_bar = capture_bar;
+    const SeriesView columns[5] = {prices->opens(), prices->highs(), prices->lows(), prices->closes(), prices->volumes()};
+    for (int c = 0; c < 5; ++c) {
+        state.column_ids[c] = seriesContentId(columns[c].data(), columns[c].size());
+    }
+    state.grid = grid;
+    state.tails = tails->capturedTails();
+    return continued && tails->complete();
+}
+
+std::vector<BacktestResult> StrategyOptimizer::optimizeIncremental(const std::string& state_path) {
+    const std::size_t variants = signalVariants();
+    if (variants == 0) {
+        std::cerr << "Incremental runs are not supported by this strategy, optimizing from bar 0" << std::endl;
+        return optimize();
+    }
+    if (signalLookback() + 1 >= RunState::OVERLAP_BARS) {
+        std::cerr << "Signals look back " << signalLookback() << " bars, more than an incremental run recomputes ("
+                  << RunState::OVERLAP_BARS - 1 << "), optimizing from bar 0" << std::endl;
+        return optimize();
+    }
+    if (!checkParamGrid()) {
+        return std::vector<BacktestResult>();
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    uint64_t grid = IncrementalRunEngine::fingerprint(variants, [this](std::size_t variant) { return variantKey(variant); },
+                                                      paramGrid(), sl_percents, tp_percents, use_sl, use_tp, pyramiding);
+    grid = hashCombine64(grid, hashBytes64(&initial_capital, sizeof(initial_capital), exclude_sl_from_winrate ? 1 : 0));
+
+    // A state only continues the same grid over a series that has only grown since
+    RunState state;
+    bool resume = RunState::load(state_path, state);
+    if (resume && (state.grid != grid || !state.continues(*prices))) {
+        std::cout << "Run state " << state_path << " is for other data or settings, optimizing from bar 0" << std::endl;
+        resume = false;
+    }
+    if (!resume) {
+        state = RunState();
+    }
+    uint64_t from_bar = state.bars;
+
+    std::vector<BacktestResult> results;
+    bool complete = continueRun(state, grid, results);
+    if (!complete && resume) {
+        std::cout << "Run state " << state_path << " could not be continued exactly, optimizing from bar 0" << std::endl;
+        results.clear();
+        state = RunState();
+        from_bar = 0;
+        complete = continueRun(state, grid, results);
+    }
+    // Variants that share a key (see optimize()) continue identical lanes; keep one result per
+    // key, ordered by key like optimize()
+    ResultCollector unique(results.size());
+    for (auto& result : results) {
+        unique.add(std::move(result));
+    }
+    results = unique.merge();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    if (complete) {
+        state.save(state_path);
+    } else {
+        // Some series does not derive from the price columns in a way that can be continued
+        std::cerr << "This strategy's state cannot be saved; the next run starts from bar 0 again" << std::endl;
+    }
+    std::ostringstream line;
+    line << ParamGrid::strategyName(paramGrid().strategyId()) << ": incremental run from bar " << from_bar << " of "
+         << prices->size() << ", " << results.size() << " passing results in " << seconds << " s\n";
+    std::cout << line.str() << std::flush;
+    return results;
+}
@@ -0,0 +1,178 @@
+#include "optimizers.h"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+// Indicator plans for each optimizer grid. Each plan must mirror the IndicatorCache lookups
+// its backtester makes; a node that is not actually read only costs its precomputation, and a
+// lookup that is not planned is still computed lazily on first use.
+
+double StrategyOptimizer::precomputeIndicators() {
+    IndicatorPlan plan;
+    planIndicators(plan);
+    if (plan.size() == 0 || !cache) {
+        return 0.0;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    if (numa_shards) {
+        // Fill every node's shard from its own pinned workers, so the series land in local memory
+        std::vector<std::unique_ptr<TaskGroup>> groups;
+        for (std::size_t s = 0; s < numa_shards->size(); ++s) {
+            NumaShards::Shard& shard = numa_shards->shard(s);
+            groups.push_back(std::make_unique<TaskGroup>(*shard.pool));
+            groups.back()->run([&plan, &shard]() { plan.execute(*shard.cache, *shard.prices, *shard.pool); });
+        }
+        for (auto& group : groups) {
+            group->wait();
+        }
+    } else {
+        plan.execute(*cache, *prices);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    // One write per line, since strategies optimized on different threads report concurrently
+    std::ostringstream line;
+    line << ParamGrid::strategyName(paramGrid().strategyId()) << ": precomputed " << plan.size()
+         << " indicator series (" << plan.depth() << " dependency levels) in " << seconds * 1000.0 << " ms\n";
+    std::cout << line.str() << std::flush;
+    return seconds;
+}
+
+void OttOptimizer::planIndicators(IndicatorPlan& plan) const {
+    IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+    for (int length : support_lengths) {
+        IndicatorPlan::Node basis = plan.var(close, length);
+        for (double multiplier : ott_multipliers) {
+            plan.ott(basis, multiplier);
+        }
+    }
+}
+
+void TottOptimizer::planIndicators(IndicatorPlan& plan) const {
+    // The bands are offsets of the OTT line and need no series of their own
+    IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+    for (int length : support_lengths) {
+        IndicatorPlan::Node basis = plan.var(close, length);
+        for (double multiplier : ott_multipliers) {
+            plan.ott(basis, multiplier);
+        }
+    }
+}
+
+void SottOptimizer::planIndicators(IndicatorPlan& plan) const {
+    IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+    IndicatorPlan::Node high = plan.column(PriceColumn::High);
+    IndicatorPlan::Node low = plan.column(PriceColumn::Low);
+    for (int k_length : stoch_k_lengths) {
+        IndicatorPlan::Node stoch = plan.stochastic(close, high, low, k_length);
+        for (int d_length : stoch_d_lengths) {
+            IndicatorPlan::Node smoothed = plan.var(stoch, d_length);
+            for (double multiplier : ott_multipliers) {
+                plan.ott(smoothed, multiplier);
+            }
+        }
+    }
+}
+
+void OttChannelOptimizer::planIndicators(IndicatorPlan& plan) const {
+    // Channel widths scale the OTT line, so only the basis and OTT series are shared
+    IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+    for (int length : ma_lengths) {
+        IndicatorPlan::Node basis = plan.var(close, length);
+        for (double multiplier : ott_multipliers) {
+            plan.ott(basis, multiplier);
+        }
+    }
+}
+
+void RisottoOptimizer::planIndicators(IndicatorPlan& plan) const {
+    IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+    for (int rsi_length : rsi_lengths) {
+        IndicatorPlan::Node rsi = plan.rsi(close, rsi_length);
+        for (int length : support_lengths) {
+            IndicatorPlan::Node basis = plan.var(rsi, length);
+            for (double multiplier : ott_multipliers) {
+                plan.ott(basis, multiplier);
+            }
+        }
+    }
+}
+
+void HottLottOptimizer::planIndicators(IndicatorPlan& plan) const {
+    // HOTT and LOTT are OTT lines over the highest high and the lowest low
+    IndicatorPlan::Node high = plan.column(PriceColumn::High);
+    IndicatorPlan::Node low = plan.column(PriceColumn::Low);
+    for (int length : hl_lengths) {
+        IndicatorPlan::Node highest = plan.highest(high, length);
+        IndicatorPlan::Node lowest = plan.lowest(low, length);
+        for (double multiplier : ott_multipliers) {
+            plan.ott(highest, multiplier);
+            plan.ott(lowest, multiplier);
+        }
+    }
+}
+
+void RottOptimizer::planIndicators(IndicatorPlan& plan) const {
+    IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+    for (int length : support_lengths) {
+        IndicatorPlan::Node basis = plan.var(close, length);
+        for (double multiplier : ott_multipliers) {
+            plan.ott(basis, multiplier);
+        }
+    }
+}
+
+void FtOptimizer::planIndicators(IndicatorPlan& plan) const {
+    IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+    for (int length : support_lengths) {
+        IndicatorPlan::Node basis = plan.var(close, length);
+        for (double multiplier : major_multipliers) {
+            plan.ott(basis, multiplier);
+        }
+        for (double multiplier : minor_multipliers) {
+            plan.ott(basis, multiplier);
+        }
+    }
+}
+
+void RtrOptimizer::planIndicators(IndicatorPlan& plan) const {
+    IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+    IndicatorPlan::Node high = plan.column(PriceColumn::High);
+    IndicatorPlan::Node low = plan.column(PriceColumn::Low);
+    for (int length : atr_lengths) {
+        plan.atr(high, low, close, length);
+    }
+    for (int length : ma_lengths) {
+        plan.var(close, length);
+    }
+}
+
+void MottOptimizer::planIndicators(IndicatorPlan& plan) const {
+    IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+    IndicatorPlan::Node high = plan.column(PriceColumn::High);
+    IndicatorPlan::Node low = plan.column(PriceColumn::Low);
+    for (int length : support_lengths) {
+        IndicatorPlan::Node basis = plan.var(close, length);
+        for (double multiplier : ott_multipliers) {
+            plan.ott(basis, multiplier);
+        }
+    }
+    for (int length : hl_lengths) {
+        plan.highest(high, length);
+        plan.lowest(low, length);
+    }
+}
+
+void BootsOptimizer::planIndicators(IndicatorPlan& plan) const {
+    IndicatorPlan::Node close = plan.column(PriceColumn::Close);
+    for (int length : support_lengths) {
+        IndicatorPlan::Node basis = plan.var(close, length);
+        for (double multiplier : ott_multipliers) {
+            plan.ott(basis, multiplier);
+        }
+    }
+    for (int length : bb_lengths) {
+        plan.bollingerBands(close, length, BootsBacktester::BB_MULTIPLIER);
+    }
+}
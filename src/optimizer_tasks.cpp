@@ -0,0 +1,81 @@
+#include "optimizers.h"
+#include <algorithm>
+
+// Queue [begin, end) on `group` in chunks, several per worker so the pool stays busy until
+// the end without a task per combination
+static void submitCombinations(TaskGroup& group, int workers, std::size_t begin, std::size_t end,
+                               const std::function<void(std::size_t, std::size_t)>& body) {
+    std::size_t grain = std::max<std::size_t>(1, (end - begin) / (static_cast<std::size_t>(workers) * 8));
+    for (std::size_t chunk = begin; chunk < end; chunk += grain) {
+        std::size_t chunk_end = std::min(end, chunk + grain);
+        group.run([&body, chunk, chunk_end]() { body(chunk, chunk_end); });
+    }
+}
+
+const PriceSeries& StrategyOptimizer::localPrices() const {
+    const NumaShards::Shard* shard = numa_shards ? numa_shards->current() : nullptr;
+    return shard != nullptr ? *shard->prices : *prices;
+}
+
+IndicatorCache& StrategyOptimizer::localCache() const {
+    const NumaShards::Shard* shard = numa_shards ? numa_shards->current() : nullptr;
+    return shard != nullptr ? *shard->cache : *cache;
+}
+
+std::vector<std::unique_ptr<TradeSimulator>> StrategyOptimizer::shardSimulators() const {
+    std::vector<std::unique_ptr<TradeSimulator>> simulators;
+    if (!numa_shards) {
+        return simulators;
+    }
+    simulators.resize(numa_shards->size());
+    std::vector<std::unique_ptr<TaskGroup>> groups;
+    for (std::size_t s = 0; s < numa_shards->size(); ++s) {
+        const NumaShards::Shard& shard = numa_shards->shard(s);
+        groups.push_back(std::make_unique<TaskGroup>(*shard.pool));
+        groups.back()->run([this, &simulators, &shard, s]() {
+            simulators[s] = std::make_unique<TradeSimulator>(*shard.prices, initial_capital, exclude_sl_from_winrate);
+        });
+    }
+    for (auto& group : groups) {
+        group->wait();
+    }
+    return simulators;
+}
+
+void StrategyOptimizer::forEachCombination(std::size_t count, const std::function<void(std::size_t)>& evaluate) {
+    // Named, so the function the queued chunks refer to outlives them
+    const std::function<void(std::size_t, std::size_t)> body = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            evaluate(i);
+        }
+        progress.fetch_add(static_cast<int>(end - begin));
+    };
+
+    if (!numa_shards) {
+        ThreadPool& pool = ThreadPool::shared();
+        TaskGroup group(pool);
+        submitCombinations(group, pool.size(), 0, count, body);
+        group.wait();
+        return;
+    }
+
+    // One contiguous share per node, so each node's workers stay on their own replica
+    int total_workers = 0;
+    for (std::size_t s = 0; s < numa_shards->size(); ++s) {
+        total_workers += numa_shards->shard(s).pool->size();
+    }
+    std::vector<std::unique_ptr<TaskGroup>> groups;
+    std::size_t begin = 0;
+    int workers_before = 0;
+    for (std::size_t s = 0; s < numa_shards->size(); ++s) {
+        ThreadPool& pool = *numa_shards->shard(s).pool;
+        workers_before += pool.size();
+        std::size_t end = count * static_cast<std::size_t>(workers_before) / static_cast<std::size_t>(total_workers);
+        groups.push_back(std::make_unique<TaskGroup>(pool));
+        submitCombinations(*groups.back(), pool.size(), begin, end, body);
+        begin = end;
+    }
+    for (auto& group : groups) {
+        group->wait();
+    }
+}
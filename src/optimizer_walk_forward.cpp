@@ -0,0 +1,62 @@
+#include "optimizers.h"
+#include <chrono>
+#include <iostream>
+
+std::vector<WalkForwardWindow> StrategyOptimizer::walkForward(const WalkForwardConfig& config) {
+    const std::size_t variants = signalVariants();
+    if (variants == 0) {
+        std::cerr << "Walk-forward is not supported by this strategy" << std::endl;
+        return std::vector<WalkForwardWindow>();
+    }
+    if (!checkParamGrid()) {
+        return std::vector<WalkForwardWindow>();
+    }
+
+    // The engine runs on the shared pool and reads the shared cache, so NUMA shards sit out
+    // rather than being filled with series nothing reads
+    std::shared_ptr<NumaShards> shards = numa_shards;
+    numa_shards.reset();
+    auto start_time = std::chrono::steady_clock::now();
+    precomputeIndicators();
+
+    TradeSimulator simulator(*prices, initial_capital, exclude_sl_from_winrate);
+    WalkForwardEngine engine(simulator, sl_percents, tp_percents, use_sl, use_tp, pyramiding);
+    std::vector<WalkForwardWindow> windows = engine.run(
+        prices->size(), config, variants,
+        [this](std::size_t variant) { return variantKey(variant); },
+        [this](std::size_t variant, std::vector<int>& dir) { return variantSignals(variant, dir); });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    numa_shards = shards;
+
+    // Out-of-sample result of trading each window's best in-sample pick
+    const ParamGrid grid = paramGrid();
+    double in_sample_profit = 0.0;
+    double out_of_sample_profit = 0.0;
+    int out_of_sample_trades = 0;
+    for (const auto& window : windows) {
+        if (window.picks.empty()) {
+            std::cout << "  " << prices->date(window.out_of_sample.begin) << ": no in-sample result passed" << std::endl;
+            continue;
+        }
+        const WalkForwardPick& best = window.picks.front();
+        in_sample_profit += best.in_sample.net_profit;
+        out_of_sample_profit += best.out_of_sample.net_profit;
+        out_of_sample_trades += best.out_of_sample.total_trades;
+        std::cout << "  " << prices->date(window.out_of_sample.begin) << " - "
+                  << prices->date(window.out_of_sample.end - 1) << ": " << grid.describe(best.key)
+                  << " in-sample " << best.in_sample.net_profit
+                  << " (" << best.in_sample.total_trades << " trades), out-of-sample "
+                  << best.out_of_sample.net_profit << " (" << best.out_of_sample.total_trades << " trades)" << std::endl;
+    }
+
+    // Walk-forward efficiency: out-of-sample profit per bar relative to in-sample profit per bar
+    std::cout << "Walk-forward: " << windows.size() << " windows x " << variants * sl_percents.size() * tp_percents.size()
+              << " combinations in " << seconds << " s, out-of-sample net profit " << out_of_sample_profit
+              << " over " << out_of_sample_trades << " trades";
+    if (!windows.empty() && in_sample_profit != 0.0) {
+        double efficiency = (out_of_sample_profit / config.out_of_sample_bars) / (in_sample_profit / config.in_sample_bars);
+        std::cout << ", efficiency " << efficiency * 100.0 << "%";
+    }
+    std::cout << std::endl;
+    return windows;
+}
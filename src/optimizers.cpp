@@ -0,0 +1,855 @@
+#include "optimizers.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+StrategyOptimizer::StrategyOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                                     const std::vector<double>& sl_pcts,
+                                     const std::vector<double>& tp_pcts,
+                                     bool enable_sl,
+                                     bool enable_tp,
+                                     bool enable_pyramiding,
+                                     double capital,
+                                     int minimum_trades,
+                                     double minimum_win_rate,
+                                     bool exclude_sl)
+    : prices(std::move(price_series)), closes(prices->closes()), highs(prices->highs()), lows(prices->lows()),
+      opens(prices->opens()), sl_percents(sl_pcts), tp_percents(tp_pcts), use_sl(enable_sl), use_tp(enable_tp),
+      pyramiding(enable_pyramiding), initial_capital(capital), min_trades(minimum_trades),
+      min_win_rate(minimum_win_rate), exclude_sl_from_winrate(exclude_sl), cache(std::make_shared<IndicatorCache>()),
+      progress(0), total_combinations(0) {}
+
+void StrategyOptimizer::setTradeSettings(const std::vector<double>& sl_pcts,
+                                         const std::vector<double>& tp_pcts,
+                                         bool enable_sl,
+                                         bool enable_tp,
+                                         bool enable_pyramiding,
+                                         double capital,
+                                         int minimum_trades,
+                                         double minimum_win_rate,
+                                         bool exclude_sl) {
+    sl_percents = sl_pcts;
+    tp_percents = tp_pcts;
+    use_sl = enable_sl;
+    use_tp = enable_tp;
+    pyramiding = enable_pyramiding;
+    initial_capital = capital;
+    min_trades = minimum_trades;
+    min_win_rate = minimum_win_rate;
+    exclude_sl_from_winrate = exclude_sl;
+}
+
+bool StrategyOptimizer::checkParamGrid() const {
+    const ParamGrid grid = paramGrid();
+    std::string problem;
+    if (grid.fitsParamKey(problem)) {
+        return true;
+    }
+    std::cerr << ParamGrid::strategyName(grid.strategyId()) << ": " << problem << ", not optimized" << std::endl;
+    return false;
+}
+
+// Grid position of a signal variant; the last dimension varies fastest, like nested loops
+// over the dimensions in declaration order. key() narrows to the 16-bit ParamKey index, which
+// checkParamGrid() has made lossless.
+struct GridIndices {
+    std::size_t index[ParamKey::MAX_DIMENSIONS];
+
+    uint16_t key(int d) const { return static_cast<uint16_t>(index[d]); }
+};
+
+static GridIndices gridIndices(std::size_t variant, std::initializer_list<std::size_t> sizes) {
+    GridIndices indices = {};
+    int d = static_cast<int>(sizes.size());
+    for (auto size = sizes.end(); size != sizes.begin();) {
+        --size;
+        indices.index[--d] = variant % *size;
+        variant /= *size;
+    }
+    return indices;
+}
+
+template <typename T>
+static ParamGrid::Dimension dimension(const std::vector<T>& values) {
+    return ParamGrid::Dimension{std::vector<double>(values.begin(), values.end()), {}};
+}
+
+static ParamGrid::Dimension labelDimension(const std::vector<std::string>& labels) {
+    return ParamGrid::Dimension{std::vector<double>(), labels};
+}
+
+std::vector<BacktestResult> StrategyOptimizer::optimize() {
+    if (!checkParamGrid()) {
+        return std::vector<BacktestResult>();
+    }
+    auto start_time = std::chrono::steady_clock::now();
+    precomputeIndicators();
+    const std::size_t variants = signalVariants();
+    const std::size_t lanes = sl_percents.size() * tp_percents.size();
+    total_combinations = static_cast<int>(variants * lanes);
+    progress = 0;
+
+    // One direction vector per variant, simulated against the whole SL x TP grid at once, with
+    // the variants spread over the shared pool. Only metrics are kept; lanes that can no
+    // longer pass the filters are dropped early, and the trades of the results that get
+    // exported are replayed afterwards. In NUMA mode each node's workers take a share of the
+    // variants and simulate on the node's own replica.
+    std::vector<std::unique_ptr<TradeSimulator>> simulators = shardSimulators();
+    if (simulators.empty()) {
+        simulators.push_back(std::make_unique<TradeSimulator>(*prices, initial_capital, exclude_sl_from_winrate));
+    }
+    BacktestFilter filter;
+    filter.min_trades = min_trades;
+    filter.min_win_rate = min_win_rate;
+    // Variants that differ only in parameters their signals ignore (HOTT-LOTT's bar count
+    // without use_sum) share a key, and only the first one claimed is simulated
+    collector = std::make_unique<ResultCollector>(variants);
+    std::atomic<std::size_t> pruned(0);
+    std::atomic<std::size_t> duplicates(0);
+    forEachCombination(variants, [&](std::size_t variant) {
+        thread_local std::vector<int> dir;
+        thread_local std::vector<BacktestMetrics> metrics;
+        const ParamKey key = variantKey(variant);
+        if (!collector->claim(key)) {
+            duplicates += lanes;
+            return;
+        }
+        if (!variantSignals(variant, dir)) {
+            return;
+        }
+        // Outside the shard pools (no NUMA) currentIndex() is past the end; the first one serves
+        const std::size_t shard = numa_shards ? numa_shards->currentIndex() : 0;
+        const TradeSimulator& simulator = *simulators[shard < simulators.size() ? shard : 0];
+        pruned += simulator.runMetrics(dir, sl_percents, tp_percents, use_sl, use_tp, pyramiding, metrics, filter);
+        for (std::size_t lane = 0; lane < metrics.size(); ++lane) {
+            if (filter.passes(metrics[lane])) {
+                BacktestResult result;
+                metrics[lane].applyTo(result);
+                result.param_key = laneKey(key, lane, tp_percents.size(), use_sl, use_tp, pyramiding);
+                collector->add(std::move(result));
+            }
+        }
+    });
+
+    // Ordered by key, so the output does not depend on scheduling
+    std::vector<BacktestResult> results = collector->merge();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::ostringstream line;
+    line << ParamGrid::strategyName(paramGrid().strategyId()) << ": tested " << total_combinations - duplicates.load()
+         << " combinations in " << seconds << " s (" << duplicates.load() << " duplicates skipped), " << pruned.load()
+         << " pruned early, " << results.size() << " passed the filters\n";
+    std::cout << line.str() << std::flush;
+    return results;
+}
+
+// Variant of a result's key: its own grid indices read back in the order variantKey() wrote
+// them. HOTT-LOTT keys without use_sum name the variant with the first bar count, which
+// produces the same signals.
+static std::size_t variantIndex(const ParamKey& key, const ParamGrid& grid) {
+    std::size_t variant = 0;
+    for (int d = 0; d + 2 < key.dimensions; ++d) {
+        variant = variant * grid.size(d) + key.index[d];
+    }
+    return variant;
+}
+
+void StrategyOptimizer::replayTopTrades(std::vector<BacktestResult>& results, const std::string& sort_by, int num_top) {
+    ResultMetric metric = ResultCollector::metricFromName(sort_by);
+    std::vector<BacktestResult*> ranked;
+    for (auto& result : results) {
+        ranked.push_back(&result);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [metric](const BacktestResult* a, const BacktestResult* b) {
+        return rankingValue(*a, metric) > rankingValue(*b, metric);
+    });
+    ranked.resize(std::min<std::size_t>(ranked.size(), static_cast<std::size_t>(std::max(num_top, 0))));
+
+    const ParamGrid grid = paramGrid();
+    TradeSimulator simulator(*prices, initial_capital, exclude_sl_from_winrate);
+    std::vector<int> dir;
+    for (BacktestResult* result : ranked) {
+        const ParamKey& key = result->param_key;
+        if (!result->trades.empty() || key.dimensions < 2 || !variantSignals(variantIndex(key, grid), dir)) {
+            continue;
+        }
+        result->trades = simulator.replay(dir, grid.value(key, key.dimensions - 2), grid.value(key, key.dimensions - 1),
+                                          (key.flags & ParamKey::USE_SL) != 0, (key.flags & ParamKey::USE_TP) != 0,
+                                          (key.flags & ParamKey::PYRAMIDING) != 0).trades;
+    }
+}
+
+void StrategyOptimizer::saveResultsToCSV(const std::vector<BacktestResult>& results,
+                                         const std::string& strategy_name,
+                                         const std::string& base_dir) {
+    std::filesystem::path dir = std::filesystem::path(base_dir) / strategy_name;
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::filesystem::path path = dir / (strategy_name + "_optimization_results.csv");
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write results to " << path.string() << std::endl;
+        return;
+    }
+
+    out << "Parameters,Net Profit,Profit %,Profit Factor,Total Trades,Winning Trades,Losing Trades,"
+        << "Win Rate,SL Trades,SL Win Rate,Max Drawdown\n";
+    for (const auto& result : results) {
+        out << '"' << result.params_str << "\"," << result.net_profit << ',' << result.profit_percent << ','
+            << result.profit_factor << ',' << result.total_trades << ',' << result.winning_trades << ','
+            << result.losing_trades << ',' << result.win_rate << ',' << result.sl_trades << ','
+            << result.sl_win_rate << ',' << result.max_drawdown << '\n';
+    }
+    std::cout << "Saved " << results.size() << " results to " << path.string() << std::endl;
+}
+
+void StrategyOptimizer::saveTradesForTopResults(const std::vector<BacktestResult>& results,
+                                                const PriceSeries& prices,
+                                                const std::string& strategy_name,
+                                                const std::string& sort_by,
+                                                int num_top,
+                                                const std::string& base_dir) {
+    ResultMetric metric = ResultCollector::metricFromName(sort_by);
+    std::vector<const BacktestResult*> ranked;
+    for (const auto& result : results) {
+        ranked.push_back(&result);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [metric](const BacktestResult* a, const BacktestResult* b) {
+        return rankingValue(*a, metric) > rankingValue(*b, metric);
+    });
+    ranked.resize(std::min<std::size_t>(ranked.size(), static_cast<std::size_t>(std::max(num_top, 0))));
+
+    std::filesystem::path dir = std::filesystem::path(base_dir) / strategy_name / "trades";
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::ofstream index(dir / "index.csv");
+    index << "Rank,Parameters," << sort_by << "\n";
+    for (std::size_t rank = 0; rank < ranked.size(); ++rank) {
+        const BacktestResult& result = *ranked[rank];
+        index << rank + 1 << ",\"" << result.params_str << "\"," << rankingValue(result, metric) << '\n';
+
+        std::ofstream out(dir / ("rank_" + std::to_string(rank + 1) + ".csv"));
+        out << "Entry Date,Exit Date,Direction,Entry Price,Exit Price,Profit,Exit Reason\n";
+        for (const auto& trade : result.trades) {
+            out << prices.date(trade.entry_index) << ',' << prices.date(trade.exit_index) << ','
+                << (trade.is_long ? "Long" : "Short") << ',' << trade.entry_price << ',' << trade.exit_price << ','
+                << trade.profit << ',' << trade.exit_reason << '\n';
+        }
+    }
+}
+
+OttOptimizer::OttOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                           const std::vector<int>& support_lens,
+                           const std::vector<double>& ott_mults,
+                           const std::vector<double>& sl_pcts,
+                           const std::vector<double>& tp_pcts,
+                           bool enable_sl,
+                           bool enable_tp,
+                           bool enable_pyramiding,
+                           double capital,
+                           int minimum_trades,
+                           double minimum_win_rate,
+                           bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      support_lengths(support_lens), ott_multipliers(ott_mults) {}
+
+ParamGrid OttOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::OTT, {dimension(support_lengths), dimension(ott_multipliers), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t OttOptimizer::signalVariants() const {
+    return support_lengths.size() * ott_multipliers.size();
+}
+
+OttParams OttOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), ott_multipliers.size()});
+    OttParams params;
+    params.support_length = support_lengths[i.index[0]];
+    params.ott_multiplier = ott_multipliers[i.index[1]];
+    return params;
+}
+
+ParamKey OttOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), ott_multipliers.size()});
+    return ParamKey(StrategyId::OTT, 0, {i.key(0), i.key(1)});
+}
+
+bool OttOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    OttBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+TottOptimizer::TottOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                             const std::vector<int>& support_lens,
+                             const std::vector<double>& ott_mults,
+                             const std::vector<double>& band_mults,
+                             const std::vector<double>& sl_pcts,
+                             const std::vector<double>& tp_pcts,
+                             bool enable_sl,
+                             bool enable_tp,
+                             bool enable_pyramiding,
+                             double capital,
+                             int minimum_trades,
+                             double minimum_win_rate,
+                             bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      support_lengths(support_lens), ott_multipliers(ott_mults), band_multipliers(band_mults) {}
+
+ParamGrid TottOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::TOTT, {dimension(support_lengths), dimension(ott_multipliers), dimension(band_multipliers), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t TottOptimizer::signalVariants() const {
+    return support_lengths.size() * ott_multipliers.size() * band_multipliers.size();
+}
+
+TottParams TottOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), ott_multipliers.size(), band_multipliers.size()});
+    TottParams params;
+    params.support_length = support_lengths[i.index[0]];
+    params.ott_multiplier = ott_multipliers[i.index[1]];
+    params.band_multiplier = band_multipliers[i.index[2]];
+    return params;
+}
+
+ParamKey TottOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), ott_multipliers.size(), band_multipliers.size()});
+    return ParamKey(StrategyId::TOTT, 0, {i.key(0), i.key(1), i.key(2)});
+}
+
+bool TottOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    TottBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+SottOptimizer::SottOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                             const std::vector<int>& stoch_k_lens,
+                             const std::vector<int>& stoch_d_lens,
+                             const std::vector<double>& ott_mults,
+                             const std::vector<double>& sl_pcts,
+                             const std::vector<double>& tp_pcts,
+                             bool enable_sl,
+                             bool enable_tp,
+                             bool enable_pyramiding,
+                             double capital,
+                             int minimum_trades,
+                             double minimum_win_rate,
+                             bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      stoch_k_lengths(stoch_k_lens), stoch_d_lengths(stoch_d_lens), ott_multipliers(ott_mults) {}
+
+ParamGrid SottOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::SOTT, {dimension(stoch_k_lengths), dimension(stoch_d_lengths), dimension(ott_multipliers), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t SottOptimizer::signalVariants() const {
+    return stoch_k_lengths.size() * stoch_d_lengths.size() * ott_multipliers.size();
+}
+
+SottParams SottOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {stoch_k_lengths.size(), stoch_d_lengths.size(), ott_multipliers.size()});
+    SottParams params;
+    params.stoch_k_length = stoch_k_lengths[i.index[0]];
+    params.stoch_d_length = stoch_d_lengths[i.index[1]];
+    params.ott_multiplier = ott_multipliers[i.index[2]];
+    return params;
+}
+
+ParamKey SottOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {stoch_k_lengths.size(), stoch_d_lengths.size(), ott_multipliers.size()});
+    return ParamKey(StrategyId::SOTT, 0, {i.key(0), i.key(1), i.key(2)});
+}
+
+bool SottOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    SottBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+OttChannelOptimizer::OttChannelOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                                         const std::vector<int>& ma_lens,
+                                         const std::vector<double>& ott_mults,
+                                         const std::vector<double>& upper_mults,
+                                         const std::vector<double>& lower_mults,
+                                         const std::vector<std::string>& channel_type_options,
+                                         const std::vector<double>& sl_pcts,
+                                         const std::vector<double>& tp_pcts,
+                                         bool enable_sl,
+                                         bool enable_tp,
+                                         bool enable_pyramiding,
+                                         double capital,
+                                         int minimum_trades,
+                                         double minimum_win_rate,
+                                         bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      ma_lengths(ma_lens), ott_multipliers(ott_mults), upper_multipliers(upper_mults), lower_multipliers(lower_mults), channel_types(channel_type_options) {}
+
+ParamGrid OttChannelOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::OTT_CHANNEL, {dimension(ma_lengths), dimension(ott_multipliers), dimension(upper_multipliers), dimension(lower_multipliers), labelDimension(channel_types), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t OttChannelOptimizer::signalVariants() const {
+    return ma_lengths.size() * ott_multipliers.size() * upper_multipliers.size() * lower_multipliers.size() * channel_types.size();
+}
+
+OttChannelParams OttChannelOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {ma_lengths.size(), ott_multipliers.size(), upper_multipliers.size(), lower_multipliers.size(), channel_types.size()});
+    OttChannelParams params;
+    params.ma_length = ma_lengths[i.index[0]];
+    params.ott_multiplier = ott_multipliers[i.index[1]];
+    params.upper_multiplier = upper_multipliers[i.index[2]];
+    params.lower_multiplier = lower_multipliers[i.index[3]];
+    params.channel_type = channel_types[i.index[4]];
+    return params;
+}
+
+ParamKey OttChannelOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {ma_lengths.size(), ott_multipliers.size(), upper_multipliers.size(), lower_multipliers.size(), channel_types.size()});
+    return ParamKey(StrategyId::OTT_CHANNEL, 0, {i.key(0), i.key(1), i.key(2), i.key(3), i.key(4)});
+}
+
+bool OttChannelOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    OttChannelBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+RisottoOptimizer::RisottoOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                                   const std::vector<int>& rsi_lens,
+                                   const std::vector<int>& support_lens,
+                                   const std::vector<double>& ott_mults,
+                                   const std::vector<double>& sl_pcts,
+                                   const std::vector<double>& tp_pcts,
+                                   bool enable_sl,
+                                   bool enable_tp,
+                                   bool enable_pyramiding,
+                                   double capital,
+                                   int minimum_trades,
+                                   double minimum_win_rate,
+                                   bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      rsi_lengths(rsi_lens), support_lengths(support_lens), ott_multipliers(ott_mults) {}
+
+ParamGrid RisottoOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::RISOTTO, {dimension(rsi_lengths), dimension(support_lengths), dimension(ott_multipliers), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t RisottoOptimizer::signalVariants() const {
+    return rsi_lengths.size() * support_lengths.size() * ott_multipliers.size();
+}
+
+RisottoParams RisottoOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {rsi_lengths.size(), support_lengths.size(), ott_multipliers.size()});
+    RisottoParams params;
+    params.rsi_length = rsi_lengths[i.index[0]];
+    params.support_length = support_lengths[i.index[1]];
+    params.ott_multiplier = ott_multipliers[i.index[2]];
+    return params;
+}
+
+ParamKey RisottoOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {rsi_lengths.size(), support_lengths.size(), ott_multipliers.size()});
+    return ParamKey(StrategyId::RISOTTO, 0, {i.key(0), i.key(1), i.key(2)});
+}
+
+bool RisottoOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    RisottoBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+HottLottOptimizer::HottLottOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                                     const std::vector<int>& hl_lens,
+                                     const std::vector<double>& ott_mults,
+                                     const std::vector<bool>& use_sum_opts,
+                                     const std::vector<int>& sum_n_bars_opts,
+                                     const std::vector<double>& sl_pcts,
+                                     const std::vector<double>& tp_pcts,
+                                     bool enable_sl,
+                                     bool enable_tp,
+                                     bool enable_pyramiding,
+                                     double capital,
+                                     int minimum_trades,
+                                     double minimum_win_rate,
+                                     bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      hl_lengths(hl_lens), ott_multipliers(ott_mults), use_sum_values(use_sum_opts), sum_n_bars_values(sum_n_bars_opts) {}
+
+ParamGrid HottLottOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::HOTT_LOTT, {dimension(hl_lengths), dimension(ott_multipliers), dimension(use_sum_values), dimension(sum_n_bars_values), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t HottLottOptimizer::signalVariants() const {
+    return hl_lengths.size() * ott_multipliers.size() * use_sum_values.size() * sum_n_bars_values.size();
+}
+
+HottLottParams HottLottOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {hl_lengths.size(), ott_multipliers.size(), use_sum_values.size(), sum_n_bars_values.size()});
+    HottLottParams params;
+    params.hl_length = hl_lengths[i.index[0]];
+    params.ott_multiplier = ott_multipliers[i.index[1]];
+    params.use_sum = use_sum_values[i.index[2]];
+    params.sum_n_bars = sum_n_bars_values[i.index[3]];
+    return params;
+}
+
+ParamKey HottLottOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {hl_lengths.size(), ott_multipliers.size(), use_sum_values.size(), sum_n_bars_values.size()});
+    // Without use_sum the bar count is not used, so every count maps to the first one
+    std::size_t sum_n = use_sum_values[i.index[2]] ? i.index[3] : 0;
+    return ParamKey(StrategyId::HOTT_LOTT, 0, {i.key(0), i.key(1), i.key(2), static_cast<uint16_t>(sum_n)});
+}
+
+bool HottLottOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    HottLottBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+std::size_t HottLottOptimizer::signalLookback() const {
+    // A side needs its condition on each of the last sum_n_bars bars
+    std::size_t lookback = 0;
+    for (bool use_sum : use_sum_values) {
+        for (int sum_n_bars : sum_n_bars_values) {
+            if (use_sum && sum_n_bars > 1) {
+                lookback = std::max(lookback, static_cast<std::size_t>(sum_n_bars - 1));
+            }
+        }
+    }
+    return lookback;
+}
+
+RottOptimizer::RottOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                             const std::vector<int>& support_lens,
+                             const std::vector<double>& ott_mults,
+                             const std::vector<double>& sl_pcts,
+                             const std::vector<double>& tp_pcts,
+                             bool enable_sl,
+                             bool enable_tp,
+                             bool enable_pyramiding,
+                             double capital,
+                             int minimum_trades,
+                             double minimum_win_rate,
+                             bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      support_lengths(support_lens), ott_multipliers(ott_mults) {}
+
+ParamGrid RottOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::ROTT, {dimension(support_lengths), dimension(ott_multipliers), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t RottOptimizer::signalVariants() const {
+    return support_lengths.size() * ott_multipliers.size();
+}
+
+RottParams RottOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), ott_multipliers.size()});
+    RottParams params;
+    params.support_length = support_lengths[i.index[0]];
+    params.ott_multiplier = ott_multipliers[i.index[1]];
+    return params;
+}
+
+ParamKey RottOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), ott_multipliers.size()});
+    return ParamKey(StrategyId::ROTT, 0, {i.key(0), i.key(1)});
+}
+
+bool RottOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    RottBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+FtOptimizer::FtOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                         const std::vector<int>& support_lens,
+                         const std::vector<double>& major_mults,
+                         const std::vector<double>& minor_mults,
+                         const std::vector<double>& sl_pcts,
+                         const std::vector<double>& tp_pcts,
+                         bool enable_sl,
+                         bool enable_tp,
+                         bool enable_pyramiding,
+                         double capital,
+                         int minimum_trades,
+                         double minimum_win_rate,
+                         bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      support_lengths(support_lens), major_multipliers(major_mults), minor_multipliers(minor_mults) {}
+
+ParamGrid FtOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::FT, {dimension(support_lengths), dimension(major_multipliers), dimension(minor_multipliers), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t FtOptimizer::signalVariants() const {
+    return support_lengths.size() * major_multipliers.size() * minor_multipliers.size();
+}
+
+FtParams FtOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), major_multipliers.size(), minor_multipliers.size()});
+    FtParams params;
+    params.support_length = support_lengths[i.index[0]];
+    params.major_multiplier = major_multipliers[i.index[1]];
+    params.minor_multiplier = minor_multipliers[i.index[2]];
+    return params;
+}
+
+ParamKey FtOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), major_multipliers.size(), minor_multipliers.size()});
+    return ParamKey(StrategyId::FT, 0, {i.key(0), i.key(1), i.key(2)});
+}
+
+bool FtOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    FtBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+RtrOptimizer::RtrOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                           const std::vector<int>& atr_lens,
+                           const std::vector<int>& ma_lens,
+                           const std::vector<double>& sl_pcts,
+                           const std::vector<double>& tp_pcts,
+                           bool enable_sl,
+                           bool enable_tp,
+                           bool enable_pyramiding,
+                           double capital,
+                           int minimum_trades,
+                           double minimum_win_rate,
+                           bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      atr_lengths(atr_lens), ma_lengths(ma_lens) {}
+
+ParamGrid RtrOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::RTR, {dimension(atr_lengths), dimension(ma_lengths), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t RtrOptimizer::signalVariants() const {
+    return atr_lengths.size() * ma_lengths.size();
+}
+
+RtrParams RtrOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {atr_lengths.size(), ma_lengths.size()});
+    RtrParams params;
+    params.atr_length = atr_lengths[i.index[0]];
+    params.ma_length = ma_lengths[i.index[1]];
+    return params;
+}
+
+ParamKey RtrOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {atr_lengths.size(), ma_lengths.size()});
+    return ParamKey(StrategyId::RTR, 0, {i.key(0), i.key(1)});
+}
+
+bool RtrOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    RtrBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+MottOptimizer::MottOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                             const std::vector<int>& support_lens,
+                             const std::vector<int>& hl_lens,
+                             const std::vector<double>& ott_mults,
+                             const std::vector<int>& ref_values,
+                             const std::vector<double>& sl_pcts,
+                             const std::vector<double>& tp_pcts,
+                             bool enable_sl,
+                             bool enable_tp,
+                             bool enable_pyramiding,
+                             double capital,
+                             int minimum_trades,
+                             double minimum_win_rate,
+                             bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      support_lengths(support_lens), hl_lengths(hl_lens), ott_multipliers(ott_mults), reference_values(ref_values) {}
+
+ParamGrid MottOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::MOTT, {dimension(support_lengths), dimension(hl_lengths), dimension(ott_multipliers), dimension(reference_values), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t MottOptimizer::signalVariants() const {
+    return support_lengths.size() * hl_lengths.size() * ott_multipliers.size() * reference_values.size();
+}
+
+MottParams MottOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), hl_lengths.size(), ott_multipliers.size(), reference_values.size()});
+    MottParams params;
+    params.support_length = support_lengths[i.index[0]];
+    params.hl_length = hl_lengths[i.index[1]];
+    params.ott_multiplier = ott_multipliers[i.index[2]];
+    params.reference = reference_values[i.index[3]];
+    return params;
+}
+
+ParamKey MottOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), hl_lengths.size(), ott_multipliers.size(), reference_values.size()});
+    return ParamKey(StrategyId::MOTT, 0, {i.key(0), i.key(1), i.key(2), i.key(3)});
+}
+
+bool MottOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    MottBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+BootsOptimizer::BootsOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                               const std::vector<int>& support_lens,
+                               const std::vector<int>& bb_lens,
+                               const std::vector<double>& ott_mults,
+                               const std::vector<double>& sl_pcts,
+                               const std::vector<double>& tp_pcts,
+                               bool enable_sl,
+                               bool enable_tp,
+                               bool enable_pyramiding,
+                               double capital,
+                               int minimum_trades,
+                               double minimum_win_rate,
+                               bool exclude_sl)
+    : StrategyOptimizer(std::move(price_series), sl_pcts, tp_pcts, enable_sl, enable_tp, enable_pyramiding, capital,
+                        minimum_trades, minimum_win_rate, exclude_sl),
+      support_lengths(support_lens), bb_lengths(bb_lens), ott_multipliers(ott_mults) {}
+
+ParamGrid BootsOptimizer::paramGrid() const {
+    return ParamGrid(StrategyId::BOOTS, {dimension(support_lengths), dimension(bb_lengths), dimension(ott_multipliers), dimension(sl_percents), dimension(tp_percents)});
+}
+
+std::size_t BootsOptimizer::signalVariants() const {
+    return support_lengths.size() * bb_lengths.size() * ott_multipliers.size();
+}
+
+BootsParams BootsOptimizer::variantParams(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), bb_lengths.size(), ott_multipliers.size()});
+    BootsParams params;
+    params.support_length = support_lengths[i.index[0]];
+    params.bb_length = bb_lengths[i.index[1]];
+    params.ott_multiplier = ott_multipliers[i.index[2]];
+    return params;
+}
+
+ParamKey BootsOptimizer::variantKey(std::size_t variant) const {
+    GridIndices i = gridIndices(variant, {support_lengths.size(), bb_lengths.size(), ott_multipliers.size()});
+    return ParamKey(StrategyId::BOOTS, 0, {i.key(0), i.key(1), i.key(2)});
+}
+
+bool BootsOptimizer::variantSignals(std::size_t variant, std::vector<int>& dir) const {
+    BootsBacktester::signals(localCache(), localPrices(), variantParams(variant), dir);
+    return true;
+}
+
+MultiStrategyOptimizer::MultiStrategyOptimizer(std::shared_ptr<const PriceSeries> price_series,
+                                               const std::vector<std::string>& strategies,
+                                               const std::vector<double>& sl_pcts,
+                                               const std::vector<double>& tp_pcts,
+                                               bool enable_sl,
+                                               bool enable_tp,
+                                               bool enable_pyramiding,
+                                               double capital,
+                                               int minimum_trades,
+                                               double minimum_win_rate,
+                                               bool exclude_sl)
+    : prices(std::move(price_series)), selected_strategies(strategies), sl_percents(sl_pcts), tp_percents(tp_pcts),
+      use_sl(enable_sl), use_tp(enable_tp), pyramiding(enable_pyramiding), initial_capital(capital),
+      min_trades(minimum_trades), min_win_rate(minimum_win_rate), exclude_sl_from_winrate(exclude_sl),
+      cache(std::make_shared<IndicatorCache>()) {}
+
+std::unique_ptr<StrategyOptimizer> createOptimizer(StrategyId id, std::shared_ptr<const PriceSeries> prices) {
+    switch (id) {
+        case StrategyId::OTT: return std::make_unique<OttOptimizer>(prices);
+        case StrategyId::TOTT: return std::make_unique<TottOptimizer>(prices);
+        case StrategyId::OTT_CHANNEL: return std::make_unique<OttChannelOptimizer>(prices);
+        case StrategyId::RISOTTO: return std::make_unique<RisottoOptimizer>(prices);
+        case StrategyId::SOTT: return std::make_unique<SottOptimizer>(prices);
+        case StrategyId::HOTT_LOTT: return std::make_unique<HottLottOptimizer>(prices);
+        case StrategyId::ROTT: return std::make_unique<RottOptimizer>(prices);
+        case StrategyId::FT: return std::make_unique<FtOptimizer>(prices);
+        case StrategyId::RTR: return std::make_unique<RtrOptimizer>(prices);
+        case StrategyId::MOTT: return std::make_unique<MottOptimizer>(prices);
+        case StrategyId::BOOTS: return std::make_unique<BootsOptimizer>(prices);
+    }
+    return nullptr;
+}
+
+void MultiStrategyOptimizer::optimizeAll() {
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<StrategyOptimizer>> optimizers;
+    for (const auto& name : selected_strategies) {
+        StrategyId id;
+        if (!ParamGrid::strategyFromName(name, id)) {
+            std::cerr << "Unknown strategy: " << name << std::endl;
+            continue;
+        }
+        std::unique_ptr<StrategyOptimizer> optimizer = createOptimizer(id, prices);
+        optimizer->setTradeSettings(sl_percents, tp_percents, use_sl, use_tp, pyramiding, initial_capital, min_trades,
+                                    min_win_rate, exclude_sl_from_winrate);
+        optimizer->setIndicatorCache(cache);
+        optimizer->setNumaShards(numa_shards);
+        names.push_back(name);
+        optimizers.push_back(std::move(optimizer));
+    }
+
+    if (walk_forward.in_sample_bars > 0) {
+        WalkForwardConfig config = walk_forward;
+        config.filter.min_trades = min_trades;
+        config.filter.min_win_rate = min_win_rate;
+        // Strategies walk forward one after another: each run already spreads its variants
+        // over the whole pool in both phases, and prints its windows as a block that
+        // concurrent runs would interleave
+        for (std::size_t i = 0; i < optimizers.size(); ++i) {
+            std::cout << "Walking " << names[i] << " forward..." << std::endl;
+            optimizers[i]->walkForward(config);
+        }
+        return;
+    }
+
+    // With a state directory every strategy continues from its own saved run
+    std::string run_dir = state_dir;
+    if (!run_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(run_dir, ec);
+        if (!std::filesystem::is_directory(run_dir, ec)) {
+            std::cerr << "Cannot use state directory " << run_dir << ", optimizing from bar 0" << std::endl;
+            run_dir.clear();
+        }
+    }
+
+    // Every strategy runs on its own thread, and all of them queue their work on the shared
+    // pool, so the pool stays busy across strategy boundaries instead of draining at the end
+    // of each grid. Results are reported and saved in the order the strategies were given.
+    std::cout << "Optimizing " << names.size() << " strategies..." << std::endl;
+    std::vector<std::vector<BacktestResult>> results(optimizers.size());
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < optimizers.size(); ++i) {
+        threads.emplace_back([this, &optimizers, &names, &results, &run_dir, i]() {
+            if (run_dir.empty()) {
+                results[i] = optimizers[i]->optimize();
+            } else {
+                std::string state_path = (std::filesystem::path(run_dir) / (names[i] + ".run")).string();
+                results[i] = optimizers[i]->optimizeIncremental(state_path);
+            }
+            std::stable_sort(results[i].begin(), results[i].end(), [](const BacktestResult& a, const BacktestResult& b) {
+                return a.net_profit > b.net_profit;
+            });
+            optimizers[i]->replayTopTrades(results[i]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (std::size_t i = 0; i < optimizers.size(); ++i) {
+        // Parameter strings are only built here, for the results that are written out
+        optimizers[i]->paramGrid().describeAll(results[i]);
+        if (!results[i].empty()) {
+            const BacktestResult& best = results[i].front();
+            std::cout << "Best " << names[i] << ": " << best.params_str << " net profit " << best.net_profit
+                      << ", win rate " << best.win_rate << "% over " << best.total_trades << " trades" << std::endl;
+        }
+        StrategyOptimizer::saveResultsToCSV(results[i], names[i]);
+        StrategyOptimizer::saveTradesForTopResults(results[i], *prices, names[i]);
+    }
+}
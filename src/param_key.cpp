@@ -0,0 +1,162 @@
+#include "param_key.h"
+#include "models.h"
+#include "hashing.h"
+
+static const char* const STRATEGY_NAMES[] = {
+    "OTT", "TOTT", "OTT_CHANNEL", "RISOTTO", "SOTT", "HOTT-LOTT", "ROTT", "FT", "RTR", "MOTT", "BOOTS"
+};
+
+ParamGrid::ParamGrid(StrategyId id, std::vector<Dimension> grid_dimensions)
+    : strategy(id), dimensions(std::move(grid_dimensions)) {}
+
+const char* ParamGrid::strategyName(StrategyId id) {
+    return STRATEGY_NAMES[static_cast<int>(id)];
+}
+
+bool ParamGrid::strategyFromName(const std::string& name, StrategyId& id) {
+    for (int i = 0; i < static_cast<int>(sizeof(STRATEGY_NAMES) / sizeof(STRATEGY_NAMES[0])); ++i) {
+        if (name == STRATEGY_NAMES[i]) {
+            id = static_cast<StrategyId>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParamGrid::fitsParamKey(std::string& problem) const {
+    if (dimensions.size() > static_cast<std::size_t>(ParamKey::MAX_DIMENSIONS)) {
+        problem = std::to_string(dimensions.size()) + " grid dimensions, a ParamKey holds " +
+                  std::to_string(ParamKey::MAX_DIMENSIONS);
+        return false;
+    }
+    for (std::size_t d = 0; d < dimensions.size(); ++d) {
+        if (size(static_cast<int>(d)) > ParamKey::MAX_VALUES) {
+            problem = std::to_string(size(static_cast<int>(d))) + " values in grid dimension " + std::to_string(d) +
+                      ", a ParamKey indexes " + std::to_string(ParamKey::MAX_VALUES);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string ParamGrid::describe(const ParamKey& key) const {
+    // Rebuild the strategy's parameter struct and let it format itself, so exported strings
+    // stay identical to the ones built per combination before
+    const int sl = key.dimensions - 2;
+    const int tp = key.dimensions - 1;
+    auto format = [&](StrategyParams& params) {
+        params.sl_percent = value(key, sl);
+        params.tp_percent = value(key, tp);
+        params.use_sl = (key.flags & ParamKey::USE_SL) != 0;
+        params.use_tp = (key.flags & ParamKey::USE_TP) != 0;
+        params.pyramiding = (key.flags & ParamKey::PYRAMIDING) != 0;
+        return params.getParamString();
+    };
+    auto integer = [&](int d) { return static_cast<int>(value(key, d)); };
+
+    switch (strategy) {
+        case StrategyId::OTT: {
+            OttParams params;
+            params.support_length = integer(0);
+            params.ott_multiplier = value(key, 1);
+            return format(params);
+        }
+        case StrategyId::TOTT: {
+            TottParams params;
+            params.support_length = integer(0);
+            params.ott_multiplier = value(key, 1);
+            params.band_multiplier = value(key, 2);
+            return format(params);
+        }
+        case StrategyId::OTT_CHANNEL: {
+            OttChannelParams params;
+            params.ma_length = integer(0);
+            params.ott_multiplier = value(key, 1);
+            params.upper_multiplier = value(key, 2);
+            params.lower_multiplier = value(key, 3);
+            params.channel_type = dimensions[4].labels[key.index[4]];
+            return format(params);
+        }
+        case StrategyId::RISOTTO: {
+            RisottoParams params;
+            params.rsi_length = integer(0);
+            params.support_length = integer(1);
+            params.ott_multiplier = value(key, 2);
+            return format(params);
+        }
+        case StrategyId::SOTT: {
+            SottParams params;
+            params.stoch_k_length = integer(0);
+            params.stoch_d_length = integer(1);
+            params.ott_multiplier = value(key, 2);
+            return format(params);
+        }
+        case StrategyId::HOTT_LOTT: {
+            HottLottParams params;
+            params.hl_length = integer(0);
+            params.ott_multiplier = value(key, 1);
+            params.use_sum = value(key, 2) != 0.0;
+            params.sum_n_bars = integer(3);
+            return format(params);
+        }
+        case StrategyId::ROTT: {
+            RottParams params;
+            params.support_length = integer(0);
+            params.ott_multiplier = value(key, 1);
+            return format(params);
+        }
+        case StrategyId::FT: {
+            FtParams params;
+            params.support_length = integer(0);
+            params.major_multiplier = value(key, 1);
+            params.minor_multiplier = value(key, 2);
+            return format(params);
+        }
+        case StrategyId::RTR: {
+            RtrParams params;
+            params.atr_length = integer(0);
+            params.ma_length = integer(1);
+            return format(params);
+        }
+        case StrategyId::MOTT: {
+            MottParams params;
+            params.support_length = integer(0);
+            params.hl_length = integer(1);
+            params.ott_multiplier = value(key, 2);
+            params.reference = integer(3);
+            return format(params);
+        }
+        case StrategyId::BOOTS: {
+            BootsParams params;
+            params.support_length = integer(0);
+            params.bb_length = integer(1);
+            params.ott_multiplier = value(key, 2);
+            return format(params);
+        }
+    }
+    return std::string();
+}
+
+void ParamGrid::describeAll(std::vector<BacktestResult>& results) const {
+    for (auto& result : results) {
+        if (result.params_str.empty()) {
+            result.params_str = describe(result.param_key);
+        }
+        if (result.strategy_name.empty()) {
+            result.strategy_name = strategyName(strategy);
+        }
+    }
+}
+
+uint64_t ParamGrid::fingerprint() const {
+    uint64_t h = hashCombine64(static_cast<uint64_t>(strategy) + 1, dimensions.size());
+    for (const Dimension& dimension : dimensions) {
+        h = hashCombine64(h, hashBytes64(dimension.values.data(), dimension.values.size() * sizeof(double),
+                                         dimension.values.size()));
+        h = hashCombine64(h, dimension.labels.size());
+        for (const std::string& label : dimension.labels) {
+            h = hashCombine64(h, hashBytes64(label.data(), label.size()));
+        }
+    }
+    return h;
+}
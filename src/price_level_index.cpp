@@ -0,0 +1,108 @@
+#include "price_level_index.h"
+#include <algorithm>
+#include <functional>
+
+// Build the block extremes (level 0) and the doubling levels above them
+template <typename Better>
+static void buildLevels(SeriesView data, std::size_t block_count, std::vector<std::vector<double>>& levels, Better better) {
+    const std::size_t block_size = PriceLevelIndex::BLOCK_SIZE;
+    levels.assign(1, std::vector<double>(block_count));
+    for (std::size_t b = 0; b < block_count; ++b) {
+        std::size_t end = std::min(data.size(), (b + 1) * block_size);
+        double extreme = data[b * block_size];
+        for (std::size_t i = b * block_size + 1; i < end; ++i) {
+            extreme = better(data[i], extreme) ? data[i] : extreme;
+        }
+        levels[0][b] = extreme;
+    }
+
+    for (std::size_t span = 2; span <= block_count; span *= 2) {
+        const std::vector<double>& below = levels.back();
+        std::vector<double> level(block_count - span + 1);
+        for (std::size_t b = 0; b < level.size(); ++b) {
+            double left = below[b];
+            double right = below[b + span / 2];
+            level[b] = better(right, left) ? right : left;
+        }
+        levels.push_back(std::move(level));
+    }
+}
+
+// Shared search over `size` bars: `bar_reaches(i)` tells whether bar i touches the level(s)
+// and `span_reaches(k, block)` whether the 2^k blocks starting at `block` contain such a bar
+template <typename BarReaches, typename SpanReaches>
+static std::size_t firstReaching(std::size_t size, const std::vector<std::vector<double>>& levels,
+                                 std::size_t from, std::size_t to, BarReaches bar_reaches, SpanReaches span_reaches) {
+    const std::size_t block_size = PriceLevelIndex::BLOCK_SIZE;
+    if (size == 0 || from > to) {
+        return PriceLevelIndex::npos;
+    }
+    to = std::min(to, size - 1);
+
+    // Rest of the first block, bar by bar
+    std::size_t i = from;
+    std::size_t first_end = std::min(to, (from / block_size + 1) * block_size - 1);
+    for (; i <= first_end; ++i) {
+        if (bar_reaches(i)) {
+            return i;
+        }
+    }
+    if (i > to) {
+        return PriceLevelIndex::npos;
+    }
+
+    // Jump over whole blocks that stay short of the level, largest spans first
+    std::size_t block = i / block_size;
+    const std::size_t last_block = to / block_size;
+    for (std::size_t k = levels.size(); k-- > 0;) {
+        std::size_t span = std::size_t(1) << k;
+        if (block + span - 1 <= last_block && block < levels[k].size() && !span_reaches(k, block)) {
+            block += span;
+        }
+    }
+    if (block > last_block) {
+        return PriceLevelIndex::npos;
+    }
+
+    // The level lies inside this block, unless it is past `to` in the last one
+    std::size_t end = std::min(to, (block + 1) * block_size - 1);
+    for (i = block * block_size; i <= end; ++i) {
+        if (bar_reaches(i)) {
+            return i;
+        }
+    }
+    return PriceLevelIndex::npos;
+}
+
+PriceLevelIndex::PriceLevelIndex(const PriceSeries& prices)
+    : highs(prices.highs()), lows(prices.lows()),
+      block_count((prices.size() + BLOCK_SIZE - 1) / BLOCK_SIZE) {
+    buildLevels(highs, block_count, block_max, std::greater<double>());
+    buildLevels(lows, block_count, block_min, std::less<double>());
+}
+
+std::size_t PriceLevelIndex::firstHighAtOrAbove(std::size_t from, std::size_t to, double level) const {
+    const double* high = highs.data();
+    return firstReaching(highs.size(), block_max, from, to,
+                         [high, level](std::size_t i) { return high[i] >= level; },
+                         [this, level](std::size_t k, std::size_t block) { return block_max[k][block] >= level; });
+}
+
+std::size_t PriceLevelIndex::firstLowAtOrBelow(std::size_t from, std::size_t to, double level) const {
+    const double* low = lows.data();
+    return firstReaching(lows.size(), block_min, from, to,
+                         [low, level](std::size_t i) { return low[i] <= level; },
+                         [this, level](std::size_t k, std::size_t block) { return block_min[k][block] <= level; });
+}
+
+std::size_t PriceLevelIndex::firstOutside(std::size_t from, std::size_t to, double low_level, double high_level) const {
+    const double* low = lows.data();
+    const double* high = highs.data();
+    return firstReaching(lows.size(), block_min, from, to,
+                         [low, high, low_level, high_level](std::size_t i) {
+                             return (low[i] <= low_level) | (high[i] >= high_level);
+                         },
+                         [this, low_level, high_level](std::size_t k, std::size_t block) {
+                             return (block_min[k][block] <= low_level) | (block_max[k][block] >= high_level);
+                         });
+}
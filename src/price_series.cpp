@@ -0,0 +1,143 @@
+#include "price_series.h"
+#include "bar_cache.h"
+#include "hashing.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+PriceSeries::PriceSeries()
+    : timestamp_column(nullptr), open_column(nullptr), high_column(nullptr),
+      low_column(nullptr), close_column(nullptr), volume_column(nullptr),
+      bar_count(0), source_checksum(0), column_ids{0, 0, 0, 0, 0}, time_of_day(false) {}
+
+std::shared_ptr<const PriceSeries> PriceSeries::fromColumns(const std::vector<int64_t>& timestamps,
+                                                            const std::vector<double>& opens,
+                                                            const std::vector<double>& highs,
+                                                            const std::vector<double>& lows,
+                                                            const std::vector<double>& closes,
+                                                            const std::vector<double>& volumes,
+                                                            uint64_t checksum,
+                                                            bool has_time_of_day) {
+    std::size_t n = closes.size();
+    std::size_t column_bytes = (n * sizeof(double) + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+    std::size_t total_bytes = column_bytes * 6;
+
+    // One aligned block holds all six columns back to back
+    void* block = ::operator new(total_bytes, std::align_val_t(COLUMN_ALIGNMENT));
+    std::shared_ptr<void> owner(block, [](void* p) {
+        ::operator delete(p, std::align_val_t(COLUMN_ALIGNMENT));
+    });
+
+    char* base = static_cast<char*>(block);
+    std::memcpy(base, timestamps.data(), n * sizeof(int64_t));
+    std::memcpy(base + column_bytes, opens.data(), n * sizeof(double));
+    std::memcpy(base + column_bytes * 2, highs.data(), n * sizeof(double));
+    std::memcpy(base + column_bytes * 3, lows.data(), n * sizeof(double));
+    std::memcpy(base + column_bytes * 4, closes.data(), n * sizeof(double));
+    std::memcpy(base + column_bytes * 5, volumes.data(), n * sizeof(double));
+
+    return fromMapped(owner,
+                      reinterpret_cast<const int64_t*>(base),
+                      reinterpret_cast<const double*>(base + column_bytes),
+                      reinterpret_cast<const double*>(base + column_bytes * 2),
+                      reinterpret_cast<const double*>(base + column_bytes * 3),
+                      reinterpret_cast<const double*>(base + column_bytes * 4),
+                      reinterpret_cast<const double*>(base + column_bytes * 5),
+                      n, checksum, nullptr, has_time_of_day);
+}
+
+std::shared_ptr<const PriceSeries> PriceSeries::fromMapped(std::shared_ptr<const void> owner,
+                                                           const int64_t* timestamps,
+                                                           const double* opens,
+                                                           const double* highs,
+                                                           const double* lows,
+                                                           const double* closes,
+                                                           const double* volumes,
+                                                           std::size_t count,
+                                                           uint64_t checksum,
+                                                           const uint64_t* column_ids,
+                                                           bool has_time_of_day) {
+    std::shared_ptr<PriceSeries> series(new PriceSeries());
+    series->storage = std::move(owner);
+    series->timestamp_column = timestamps;
+    series->open_column = opens;
+    series->high_column = highs;
+    series->low_column = lows;
+    series->close_column = closes;
+    series->volume_column = volumes;
+    series->bar_count = count;
+    series->source_checksum = checksum;
+    series->time_of_day = has_time_of_day;
+    
+    const double* columns[5] = {opens, highs, lows, closes, volumes};
+    for (int c = 0; c < 5; ++c) {
+        series->column_ids[c] = column_ids != nullptr ? column_ids[c] : seriesContentId(columns[c], count);
+    }
+    
+    if (series->source_checksum == 0) {
+        series->source_checksum = columnsChecksum(timestamps, count, series->column_ids);
+    }
+    return series;
+}
+
+uint64_t PriceSeries::columnsChecksum(const int64_t* timestamps, std::size_t count, const uint64_t* column_ids) {
+    uint64_t h = hashBytes64(timestamps, count * sizeof(int64_t));
+    for (int c = 0; c < 5; ++c) {
+        h = hashCombine64(h, column_ids[c]);
+    }
+    return h;
+}
+
+std::shared_ptr<const PriceSeries> PriceSeries::load(const std::string& csv_filename, bool use_bar_cache) {
+    auto start_time = std::chrono::steady_clock::now();
+
+    if (use_bar_cache) {
+        auto cached = BarCache::map(csv_filename);
+        if (cached) {
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+            std::cout << "Mapped " << cached->size() << " bars from bar cache " << BarCache::cachePath(csv_filename)
+                      << " in " << ms << " ms" << std::endl;
+            return cached;
+        }
+    }
+
+    // Stamp the CSV before parsing it, so a cache is only written for the version parsed
+    BarSourceStamp source;
+    bool stamped = use_bar_cache && BarCache::stampSource(csv_filename, source);
+
+    std::vector<int64_t> timestamps;
+    std::vector<double> opens, highs, lows, closes, volumes;
+    bool has_time_of_day = false;
+    if (!loadCSVColumns(csv_filename, timestamps, opens, highs, lows, closes, volumes, has_time_of_day)) {
+        return nullptr;
+    }
+
+    if (stamped) {
+        if (BarCache::save(csv_filename, source, timestamps, opens, highs, lows, closes, volumes, has_time_of_day)) {
+            std::cout << "Wrote bar cache " << BarCache::cachePath(csv_filename) << std::endl;
+
+            // Serve this run from the mapping too, so the parsed columns can be released
+            auto cached = BarCache::map(csv_filename);
+            if (cached) {
+                return cached;
+            }
+        } else {
+            std::cerr << "Warning: could not write bar cache " << BarCache::cachePath(csv_filename)
+                      << " (the CSV may have changed while it was read)" << std::endl;
+        }
+    }
+
+    return fromColumns(timestamps, opens, highs, lows, closes, volumes, 0, has_time_of_day);
+}
+
+Bar PriceSeries::bar(std::size_t i) const {
+    Bar result;
+    result.date = date(i);
+    result.open = open_column[i];
+    result.high = high_column[i];
+    result.low = low_column[i];
+    result.close = close_column[i];
+    result.volume = volume_column[i];
+    return result;
+}
@@ -0,0 +1,177 @@
+#include "result_collector.h"
+#include "hashing.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <tuple>
+
+// Arena of the calling thread in the collector it last added to
+struct ArenaCache {
+    uint64_t collector_id = 0;
+    void* arena = nullptr;
+};
+
+static thread_local ArenaCache arena_cache;
+static std::atomic<uint64_t> next_collector_id(1);
+
+// Total order on keys: by hash, then field by field, so equal hashes of different keys
+// still sort and deduplicate correctly
+static bool keyBefore(uint64_t a_hash, const ParamKey& a, uint64_t b_hash, const ParamKey& b) {
+    if (a_hash != b_hash) {
+        return a_hash < b_hash;
+    }
+    if (a.strategy != b.strategy || a.dimensions != b.dimensions || a.flags != b.flags) {
+        return std::make_tuple(a.strategy, a.dimensions, a.flags) < std::make_tuple(b.strategy, b.dimensions, b.flags);
+    }
+    return std::lexicographical_compare(a.index, a.index + a.dimensions, b.index, b.index + b.dimensions);
+}
+
+ResultCollector::ResultCollector(std::size_t expected_combinations)
+    : seen_count(0), collector_id(next_collector_id.fetch_add(1)) {
+    std::size_t capacity = 64;
+    while (capacity < expected_combinations * 2) {
+        capacity *= 2;
+    }
+    seen.reset(new Slot[capacity]);
+    seen_mask = capacity - 1;
+    seen_limit = capacity / 4 * 3;
+}
+
+ResultMetric ResultCollector::metricFromName(const std::string& name) {
+    if (name == "net_profit") return ResultMetric::NetProfit;
+    if (name == "win_rate") return ResultMetric::WinRate;
+    if (name == "profit_factor") return ResultMetric::ProfitFactor;
+    if (name == "profit_percent") return ResultMetric::ProfitPercent;
+    if (name == "max_drawdown") return ResultMetric::MaxDrawdown;
+    std::cerr << "Unknown result metric '" << name << "', ranking by net_profit" << std::endl;
+    return ResultMetric::NetProfit;
+}
+
+bool ResultCollector::claim(const ParamKey& key) {
+    const uint64_t hash = key.hash();
+    const uint64_t tag = hash | 2;
+    for (std::size_t i = mix64(hash) & seen_mask;; i = (i + 1) & seen_mask) {
+        Slot& slot = seen[i];
+        uint64_t current = slot.tag.load(std::memory_order_acquire);
+        if (current == 0) {
+            if (seen_count.fetch_add(1, std::memory_order_relaxed) >= seen_limit) {
+                std::cerr << "ResultCollector: more than " << seen_limit << " distinct combinations claimed, "
+                          << "the collector was sized for fewer" << std::endl;
+                std::abort();
+            }
+            if (slot.tag.compare_exchange_strong(current, Slot::WRITING, std::memory_order_acquire)) {
+                slot.key = key;
+                slot.tag.store(tag, std::memory_order_release);
+                return true;
+            }
+            seen_count.fetch_sub(1, std::memory_order_relaxed);
+        }
+        while (current == Slot::WRITING) {
+            std::this_thread::yield();
+            current = slot.tag.load(std::memory_order_acquire);
+        }
+        if (current == tag && slot.key == key) {
+            return false;
+        }
+    }
+}
+
+ResultCollector::Arena& ResultCollector::localArena() {
+    if (arena_cache.collector_id == collector_id) {
+        return *static_cast<Arena*>(arena_cache.arena);
+    }
+
+    std::lock_guard<std::mutex> lock(arenas_mutex);
+    std::thread::id self = std::this_thread::get_id();
+    Arena* arena = nullptr;
+    for (const auto& existing : arenas) {
+        if (existing->owner == self) {
+            arena = existing.get();
+        }
+    }
+    if (arena == nullptr) {
+        arenas.push_back(std::make_unique<Arena>());
+        arena = arenas.back().get();
+        arena->owner = self;
+        arena->pool = ThreadPool::current();
+    }
+    arena_cache.collector_id = collector_id;
+    arena_cache.arena = arena;
+    return *arena;
+}
+
+void ResultCollector::add(BacktestResult&& result) {
+    localArena().results.push_back(std::move(result));
+}
+
+std::vector<BacktestResult> ResultCollector::merge(std::size_t top_k, ResultMetric metric) {
+    struct Ranked {
+        uint64_t hash;
+        BacktestResult* result;
+    };
+    auto byKey = [](const Ranked& a, const Ranked& b) {
+        return keyBefore(a.hash, a.result->param_key, b.hash, b.result->param_key);
+    };
+    auto sameKey = [](const Ranked& a, const Ranked& b) {
+        return a.hash == b.hash && a.result->param_key == b.result->param_key;
+    };
+    auto byMetric = [metric, &byKey](const Ranked& a, const Ranked& b) {
+        double x = rankingValue(*a.result, metric);
+        double y = rankingValue(*b.result, metric);
+        return x != y ? x > y : byKey(a, b);
+    };
+
+    // Per arena, in parallel: drop duplicates, then everything below its own top K. Any
+    // result in the overall top K is within the top K of its arena.
+    std::vector<std::vector<Ranked>> kept(arenas.size());
+    std::vector<std::unique_ptr<TaskGroup>> groups;
+    std::vector<ThreadPool*> group_pools;
+    for (std::size_t a = 0; a < arenas.size(); ++a) {
+        ThreadPool* pool = arenas[a]->pool != nullptr ? arenas[a]->pool : &ThreadPool::shared();
+        std::size_t g = std::find(group_pools.begin(), group_pools.end(), pool) - group_pools.begin();
+        if (g == group_pools.size()) {
+            group_pools.push_back(pool);
+            groups.push_back(std::make_unique<TaskGroup>(*pool));
+        }
+        groups[g]->run([&, a]() {
+            Arena& arena = *arenas[a];
+            std::vector<Ranked>& ranked = kept[a];
+            ranked.reserve(arena.results.size());
+            for (std::size_t i = 0; i < arena.results.size(); ++i) {
+                ranked.push_back({arena.results[i].param_key.hash(), &arena.results[i]});
+            }
+            std::sort(ranked.begin(), ranked.end(), byKey);
+            ranked.erase(std::unique(ranked.begin(), ranked.end(), sameKey), ranked.end());
+            if (top_k > 0 && ranked.size() > top_k) {
+                std::nth_element(ranked.begin(), ranked.begin() + top_k, ranked.end(), byMetric);
+                ranked.resize(top_k);
+            }
+        });
+    }
+    for (auto& group : groups) {
+        group->wait();
+    }
+
+    std::vector<Ranked> all;
+    for (const auto& ranked : kept) {
+        all.insert(all.end(), ranked.begin(), ranked.end());
+    }
+    std::sort(all.begin(), all.end(), byKey);
+    all.erase(std::unique(all.begin(), all.end(), sameKey), all.end());
+    if (top_k > 0) {
+        std::size_t count = std::min(top_k, all.size());
+        std::partial_sort(all.begin(), all.begin() + count, all.end(), byMetric);
+        all.resize(count);
+    }
+
+    std::vector<BacktestResult> results;
+    results.reserve(all.size());
+    for (const auto& ranked : all) {
+        results.push_back(std::move(*ranked.result));
+    }
+    for (auto& arena : arenas) {
+        arena->results.clear();
+    }
+    return results;
+}
@@ -0,0 +1,131 @@
+#include "simd_kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#ifdef HAVE_SIMD_X86
+// Defined in simd_kernels_avx2.cpp and simd_kernels_avx512.cpp, which are compiled with the
+// matching -m flags; they must only be called after the CPU check below
+const SimdKernelTable& simdKernelsAVX2();
+const SimdKernelTable& simdKernelsAVX512();
+#endif
+
+static void absChangeScalar(const double* data, std::size_t period, std::size_t begin, std::size_t end, double* out) {
+    for (std::size_t i = begin; i < end; ++i) {
+        out[i] = std::abs(data[i] - data[i - period]);
+    }
+}
+
+static void trueRangeScalar(const double* highs, const double* lows, const double* closes,
+                            std::size_t begin, std::size_t end, double* out) {
+    for (std::size_t i = begin; i < end; ++i) {
+        double tr1 = highs[i] - lows[i];
+        double tr2 = std::abs(highs[i] - closes[i - 1]);
+        double tr3 = std::abs(lows[i] - closes[i - 1]);
+        out[i] = std::max({tr1, tr2, tr3});
+    }
+}
+
+static void efficiencyRatioScalar(const double* momentum, const double* volatility,
+                                  std::size_t begin, std::size_t end, double* out) {
+    for (std::size_t i = begin; i < end; ++i) {
+        double quotient = momentum[i] / (volatility[i] != 0.0 ? volatility[i] : 1.0);
+        out[i] = volatility[i] != 0.0 ? quotient : 0.0;
+    }
+}
+
+static void stochasticKScalar(const double* closes, const double* highest, const double* lowest,
+                              std::size_t begin, std::size_t end, double* out) {
+    for (std::size_t i = begin; i < end; ++i) {
+        double range = highest[i] - lowest[i];
+        out[i] = range > 0 ? (closes[i] - lowest[i]) / range * 100.0 : 100.0;
+    }
+}
+
+static void bollingerBandsScalar(const double* basis, const double* centered, const double* sum_x, const double* sum_xx,
+                                 double length, double multiplier, std::size_t begin, std::size_t end,
+                                 double* upper, double* lower) {
+    for (std::size_t i = begin; i < end; ++i) {
+        double c = centered[i];
+        double sum_sq = sum_xx[i] - 2.0 * c * sum_x[i] + length * c * c;
+        double stdev = std::sqrt(std::max(sum_sq, 0.0) / length);
+        upper[i] = basis[i] + (multiplier * stdev);
+        lower[i] = basis[i] - (multiplier * stdev);
+    }
+}
+
+static const SimdKernelTable SCALAR_KERNELS = {
+    SimdLevel::Scalar,
+    absChangeScalar,
+    trueRangeScalar,
+    efficiencyRatioScalar,
+    stochasticKScalar,
+    bollingerBandsScalar
+};
+
+static std::atomic<const SimdKernelTable*> active_table(nullptr);
+
+const SimdKernelTable* SimdKernels::table(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar:
+            return &SCALAR_KERNELS;
+#ifdef HAVE_SIMD_X86
+        case SimdLevel::AVX2:
+            return __builtin_cpu_supports("avx2") ? &simdKernelsAVX2() : nullptr;
+        case SimdLevel::AVX512:
+            return __builtin_cpu_supports("avx512f") ? &simdKernelsAVX512() : nullptr;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+SimdLevel SimdKernels::detect() {
+    if (table(SimdLevel::AVX512) != nullptr) {
+        return SimdLevel::AVX512;
+    }
+    if (table(SimdLevel::AVX2) != nullptr) {
+        return SimdLevel::AVX2;
+    }
+    return SimdLevel::Scalar;
+}
+
+const SimdKernelTable& SimdKernels::active() {
+    const SimdKernelTable* current = active_table.load(std::memory_order_acquire);
+    if (current == nullptr) {
+        // Racing first calls all detect the same table, so either store is fine
+        current = table(detect());
+        active_table.store(current, std::memory_order_release);
+    }
+    return *current;
+}
+
+bool SimdKernels::setLevel(SimdLevel level) {
+    const SimdKernelTable* requested = table(level);
+    if (requested == nullptr) {
+        return false;
+    }
+    active_table.store(requested, std::memory_order_release);
+    return true;
+}
+
+const char* SimdKernels::levelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+bool SimdKernels::levelFromName(const char* name, SimdLevel& level) {
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512};
+    for (SimdLevel candidate : levels) {
+        if (std::strcmp(name, levelName(candidate)) == 0) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,100 @@
+#include "simd_kernels.h"
+#include <immintrin.h>
+
+// AVX2 versions of the kernels in simd_kernels.cpp, four doubles per step. This file is built
+// with -mavx2 and only reached after a CPU check; remainders go through the scalar kernels.
+
+static const SimdKernelTable& scalarKernels() {
+    return *SimdKernels::table(SimdLevel::Scalar);
+}
+
+static inline __m256d absolute(__m256d x) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+static void absChangeAVX2(const double* data, std::size_t period, std::size_t begin, std::size_t end, double* out) {
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m256d change = _mm256_sub_pd(_mm256_loadu_pd(data + i), _mm256_loadu_pd(data + i - period));
+        _mm256_storeu_pd(out + i, absolute(change));
+    }
+    scalarKernels().absChange(data, period, i, end, out);
+}
+
+static void trueRangeAVX2(const double* highs, const double* lows, const double* closes,
+                          std::size_t begin, std::size_t end, double* out) {
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m256d high = _mm256_loadu_pd(highs + i);
+        __m256d low = _mm256_loadu_pd(lows + i);
+        __m256d previous = _mm256_loadu_pd(closes + i - 1);
+        __m256d tr1 = _mm256_sub_pd(high, low);
+        __m256d tr2 = absolute(_mm256_sub_pd(high, previous));
+        __m256d tr3 = absolute(_mm256_sub_pd(low, previous));
+        // max_pd(b, a) is (b > a ? b : a), which is how std::max({a, b, c}) picks
+        _mm256_storeu_pd(out + i, _mm256_max_pd(tr3, _mm256_max_pd(tr2, tr1)));
+    }
+    scalarKernels().trueRange(highs, lows, closes, i, end, out);
+}
+
+static void efficiencyRatioAVX2(const double* momentum, const double* volatility,
+                                std::size_t begin, std::size_t end, double* out) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m256d v = _mm256_loadu_pd(volatility + i);
+        __m256d nonzero = _mm256_cmp_pd(v, zero, _CMP_NEQ_UQ);
+        __m256d quotient = _mm256_div_pd(_mm256_loadu_pd(momentum + i), _mm256_blendv_pd(one, v, nonzero));
+        _mm256_storeu_pd(out + i, _mm256_and_pd(quotient, nonzero));
+    }
+    scalarKernels().efficiencyRatio(momentum, volatility, i, end, out);
+}
+
+static void stochasticKAVX2(const double* closes, const double* highest, const double* lowest,
+                            std::size_t begin, std::size_t end, double* out) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d hundred = _mm256_set1_pd(100.0);
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m256d low = _mm256_loadu_pd(lowest + i);
+        __m256d range = _mm256_sub_pd(_mm256_loadu_pd(highest + i), low);
+        __m256d k = _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(closes + i), low), range), hundred);
+        _mm256_storeu_pd(out + i, _mm256_blendv_pd(hundred, k, _mm256_cmp_pd(range, zero, _CMP_GT_OQ)));
+    }
+    scalarKernels().stochasticK(closes, highest, lowest, i, end, out);
+}
+
+static void bollingerBandsAVX2(const double* basis, const double* centered, const double* sum_x, const double* sum_xx,
+                               double length, double multiplier, std::size_t begin, std::size_t end,
+                               double* upper, double* lower) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d two = _mm256_set1_pd(2.0);
+    const __m256d window = _mm256_set1_pd(length);
+    const __m256d scale = _mm256_set1_pd(multiplier);
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m256d c = _mm256_loadu_pd(centered + i);
+        __m256d cross = _mm256_mul_pd(_mm256_mul_pd(two, c), _mm256_loadu_pd(sum_x + i));
+        __m256d sum_sq = _mm256_add_pd(_mm256_sub_pd(_mm256_loadu_pd(sum_xx + i), cross),
+                                       _mm256_mul_pd(_mm256_mul_pd(window, c), c));
+        __m256d stdev = _mm256_sqrt_pd(_mm256_div_pd(_mm256_max_pd(zero, sum_sq), window));
+        __m256d deviation = _mm256_mul_pd(scale, stdev);
+        __m256d mid = _mm256_loadu_pd(basis + i);
+        _mm256_storeu_pd(upper + i, _mm256_add_pd(mid, deviation));
+        _mm256_storeu_pd(lower + i, _mm256_sub_pd(mid, deviation));
+    }
+    scalarKernels().bollingerBands(basis, centered, sum_x, sum_xx, length, multiplier, i, end, upper, lower);
+}
+
+const SimdKernelTable& simdKernelsAVX2() {
+    static const SimdKernelTable kernels = {
+        SimdLevel::AVX2,
+        absChangeAVX2,
+        trueRangeAVX2,
+        efficiencyRatioAVX2,
+        stochasticKAVX2,
+        bollingerBandsAVX2
+    };
+    return kernels;
+}
@@ -0,0 +1,112 @@
+#include "simd_kernels.h"
+#include <immintrin.h>
+
+// AVX-512 versions of the kernels in simd_kernels.cpp, eight doubles per step. This file is built
+// with -mavx512f and only reached after a CPU check; remainders go through the scalar kernels.
+
+static const SimdKernelTable& scalarKernels() {
+    return *SimdKernels::table(SimdLevel::Scalar);
+}
+
+static inline __m512d absolute(__m512d x) {
+    return _mm512_abs_pd(x);
+}
+
+// The unmasked max and sqrt intrinsics merge into _mm512_undefined_pd(), which GCC reports
+// under -Wmaybe-uninitialized. The zero-masking forms with every lane selected give the same
+// result from a defined operand.
+static const __mmask8 ALL_LANES = 0xff;
+
+static inline __m512d maximum(__m512d a, __m512d b) {
+    return _mm512_maskz_max_pd(ALL_LANES, a, b);
+}
+
+static inline __m512d squareRoot(__m512d x) {
+    return _mm512_maskz_sqrt_pd(ALL_LANES, x);
+}
+
+static void absChangeAVX512(const double* data, std::size_t period, std::size_t begin, std::size_t end, double* out) {
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m512d change = _mm512_sub_pd(_mm512_loadu_pd(data + i), _mm512_loadu_pd(data + i - period));
+        _mm512_storeu_pd(out + i, absolute(change));
+    }
+    scalarKernels().absChange(data, period, i, end, out);
+}
+
+static void trueRangeAVX512(const double* highs, const double* lows, const double* closes,
+                          std::size_t begin, std::size_t end, double* out) {
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m512d high = _mm512_loadu_pd(highs + i);
+        __m512d low = _mm512_loadu_pd(lows + i);
+        __m512d previous = _mm512_loadu_pd(closes + i - 1);
+        __m512d tr1 = _mm512_sub_pd(high, low);
+        __m512d tr2 = absolute(_mm512_sub_pd(high, previous));
+        __m512d tr3 = absolute(_mm512_sub_pd(low, previous));
+        // maximum(b, a) is (b > a ? b : a), which is how std::max({a, b, c}) picks
+        _mm512_storeu_pd(out + i, maximum(tr3, maximum(tr2, tr1)));
+    }
+    scalarKernels().trueRange(highs, lows, closes, i, end, out);
+}
+
+static void efficiencyRatioAVX512(const double* momentum, const double* volatility,
+                                std::size_t begin, std::size_t end, double* out) {
+    const __m512d zero = _mm512_setzero_pd();
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m512d v = _mm512_loadu_pd(volatility + i);
+        // Lanes with zero volatility are not divided and come out as 0
+        __mmask8 nonzero = _mm512_cmp_pd_mask(v, zero, _CMP_NEQ_UQ);
+        _mm512_storeu_pd(out + i, _mm512_maskz_div_pd(nonzero, _mm512_loadu_pd(momentum + i), v));
+    }
+    scalarKernels().efficiencyRatio(momentum, volatility, i, end, out);
+}
+
+static void stochasticKAVX512(const double* closes, const double* highest, const double* lowest,
+                            std::size_t begin, std::size_t end, double* out) {
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d hundred = _mm512_set1_pd(100.0);
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m512d low = _mm512_loadu_pd(lowest + i);
+        __m512d range = _mm512_sub_pd(_mm512_loadu_pd(highest + i), low);
+        __m512d k = _mm512_mul_pd(_mm512_div_pd(_mm512_sub_pd(_mm512_loadu_pd(closes + i), low), range), hundred);
+        _mm512_storeu_pd(out + i, _mm512_mask_blend_pd(_mm512_cmp_pd_mask(range, zero, _CMP_GT_OQ), hundred, k));
+    }
+    scalarKernels().stochasticK(closes, highest, lowest, i, end, out);
+}
+
+static void bollingerBandsAVX512(const double* basis, const double* centered, const double* sum_x, const double* sum_xx,
+                               double length, double multiplier, std::size_t begin, std::size_t end,
+                               double* upper, double* lower) {
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d two = _mm512_set1_pd(2.0);
+    const __m512d window = _mm512_set1_pd(length);
+    const __m512d scale = _mm512_set1_pd(multiplier);
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m512d c = _mm512_loadu_pd(centered + i);
+        __m512d cross = _mm512_mul_pd(_mm512_mul_pd(two, c), _mm512_loadu_pd(sum_x + i));
+        __m512d sum_sq = _mm512_add_pd(_mm512_sub_pd(_mm512_loadu_pd(sum_xx + i), cross),
+                                       _mm512_mul_pd(_mm512_mul_pd(window, c), c));
+        __m512d stdev = squareRoot(_mm512_div_pd(maximum(zero, sum_sq), window));
+        __m512d deviation = _mm512_mul_pd(scale, stdev);
+        __m512d mid = _mm512_loadu_pd(basis + i);
+        _mm512_storeu_pd(upper + i, _mm512_add_pd(mid, deviation));
+        _mm512_storeu_pd(lower + i, _mm512_sub_pd(mid, deviation));
+    }
+    scalarKernels().bollingerBands(basis, centered, sum_x, sum_xx, length, multiplier, i, end, upper, lower);
+}
+
+const SimdKernelTable& simdKernelsAVX512() {
+    static const SimdKernelTable kernels = {
+        SimdLevel::AVX512,
+        absChangeAVX512,
+        trueRangeAVX512,
+        efficiencyRatioAVX512,
+        stochasticKAVX512,
+        bollingerBandsAVX512
+    };
+    return kernels;
+}
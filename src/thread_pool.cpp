@@ -0,0 +1,192 @@
+#include "thread_pool.h"
+#include "numa_topology.h"
+#include <algorithm>
+
+// Pool and queue the current thread works for, so tasks submitted from inside a task land on
+// the submitting worker's own deque
+static thread_local ThreadPool* current_pool = nullptr;
+static thread_local std::size_t current_queue = 0;
+
+static std::atomic<int> shared_pool_size(0);
+
+ThreadPool::ThreadPool(int num_threads, int node)
+    : numa_node(node), pending(0), next_queue(0), stopping(false) {
+    if (num_threads <= 0) {
+        num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    num_threads = std::max(num_threads, 1);
+
+    for (int i = 0; i < num_threads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 0; i < num_threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, static_cast<std::size_t>(i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping.store(true);
+    }
+    work_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(shared_pool_size.load());
+    return pool;
+}
+
+void ThreadPool::setSharedSize(int num_threads) {
+    shared_pool_size.store(num_threads);
+}
+
+int ThreadPool::currentNode() {
+    return current_pool != nullptr ? current_pool->numa_node : -1;
+}
+
+bool ThreadPool::ownsCurrentThread() const {
+    return current_pool == this;
+}
+
+ThreadPool* ThreadPool::current() {
+    return current_pool;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    std::size_t queue = current_pool == this ? current_queue : next_queue.fetch_add(1) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+        queues[queue]->tasks.push_back(std::move(task));
+    }
+    pending.fetch_add(1);
+
+    // Taking the lock orders the increment before a sleeping worker's re-check
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    work_available.notify_one();
+}
+
+bool ThreadPool::popTask(std::size_t queue, std::function<void()>& task) {
+    std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+    if (queues[queue]->tasks.empty()) {
+        return false;
+    }
+    task = std::move(queues[queue]->tasks.back());
+    queues[queue]->tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::stealTask(std::size_t thief, std::function<void()>& task) {
+    // Steal the oldest task, which tends to be the largest piece of work left
+    for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+        Queue& victim = *queues[(thief + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runPendingTask() {
+    if (pending.load() == 0) {
+        return false;
+    }
+    std::size_t queue = current_pool == this ? current_queue : next_queue.fetch_add(1) % queues.size();
+    std::function<void()> task;
+    if (!popTask(queue, task) && !stealTask(queue, task)) {
+        return false;
+    }
+    pending.fetch_sub(1);
+    task();
+    return true;
+}
+
+void ThreadPool::waitForTask(const std::function<bool()>& ready) {
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    work_available.wait(lock, [&]() { return pending.load() > 0 || stopping.load() || ready(); });
+}
+
+void ThreadPool::wakeWaiters() {
+    // Taking the lock orders the caller's state change before a waiter's re-check
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    work_available.notify_all();
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    current_pool = this;
+    current_queue = index;
+    if (numa_node >= 0) {
+        NumaTopology::bindCurrentThread(numa_node);
+    }
+
+    while (true) {
+        if (runPendingTask()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        work_available.wait(lock, [this]() { return pending.load() > 0 || stopping.load(); });
+        if (stopping.load() && pending.load() == 0) {
+            return;
+        }
+    }
+}
+
+TaskGroup::TaskGroup(ThreadPool& thread_pool) : pool(thread_pool), outstanding(0) {}
+
+void TaskGroup::run(std::function<void()> task) {
+    outstanding.fetch_add(1);
+    pool.submit([this, task = std::move(task)]() {
+        task();
+        // The last task notifies under the lock, so wait() cannot return and destroy the
+        // group while it is still being touched here
+        std::lock_guard<std::mutex> lock(done_mutex);
+        if (outstanding.fetch_sub(1) == 1) {
+            done.notify_all();
+            pool.wakeWaiters();
+        }
+    });
+}
+
+void TaskGroup::wait() {
+    if (pool.ownsCurrentThread()) {
+        // Workers help with pending work (ours or anyone's) and sleep only when there is none
+        while (outstanding.load() > 0) {
+            if (!pool.runPendingTask()) {
+                pool.waitForTask([this]() { return outstanding.load() == 0; });
+            }
+        }
+        std::lock_guard<std::mutex> lock(done_mutex);
+    } else {
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done.wait(lock, [this]() { return outstanding.load() == 0; });
+    }
+}
+
+void parallelFor(std::size_t count, std::size_t grain,
+                 const std::function<void(std::size_t, std::size_t)>& body,
+                 ThreadPool& pool) {
+    grain = std::max<std::size_t>(grain, 1);
+    if (count <= grain) {
+        if (count > 0) {
+            body(0, count);
+        }
+        return;
+    }
+
+    TaskGroup group(pool);
+    for (std::size_t begin = 0; begin < count; begin += grain) {
+        std::size_t end = std::min(count, begin + grain);
+        group.run([&body, begin, end]() { body(begin, end); });
+    }
+    group.wait();
+}
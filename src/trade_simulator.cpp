@@ -0,0 +1,356 @@
+#include "trade_simulator.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+// A position leaving on its stop or target
+struct LevelExit {
+    size_t bar;
+    size_t position;
+    bool stopped;
+};
+
+// Per-thread buffers reused from run to run, so a warm metrics-only run allocates nothing
+struct SimulationScratch {
+    std::vector<size_t> signal_index;
+    std::vector<double> signal_side;
+    std::vector<OpenPosition> positions;
+    std::vector<LevelExit> exits;
+    std::vector<MetricsAccumulator> lanes;
+};
+
+static SimulationScratch& threadScratch() {
+    thread_local SimulationScratch scratch;
+    return scratch;
+}
+
+static const double NO_LEVEL = std::numeric_limits<double>::infinity();
+
+// Stop and target of a new position; disabled levels sit at +/-infinity so they never trigger
+template <bool UseSL, bool UseTP>
+static void setLevels(double entry_price, double side, double sl_percent, double tp_percent,
+                      double& stop, double& target) {
+    stop = UseSL ? entry_price * (1.0 - side * sl_percent / 100.0) : -side * NO_LEVEL;
+    target = UseTP ? entry_price * (1.0 + side * tp_percent / 100.0) : side * NO_LEVEL;
+}
+
+static void closeTrade(MetricsAccumulator& metrics, std::vector<Trade>* trades, const OpenPosition& position,
+                       int exit_index, double exit_price, const char* reason, bool stop_loss, double capital) {
+    double profit = capital * position.side * (exit_price / position.entry_price - 1.0);
+    metrics.addTrade(profit, stop_loss);
+
+    if (trades != nullptr) {
+        Trade trade;
+        trade.entry_index = position.entry_index;
+        trade.exit_index = exit_index;
+        trade.entry_price = position.entry_price;
+        trade.exit_price = exit_price;
+        trade.profit = profit;
+        trade.is_long = position.side > 0;
+        trade.exit_reason = reason;
+        trades->push_back(std::move(trade));
+    }
+}
+
+TradeSimulator::TradeSimulator(const PriceSeries& prices, double capital, bool exclude_sl)
+    : closes(prices.closes()), highs(prices.highs()), lows(prices.lows()), level_index(std::make_shared<PriceLevelIndex>(prices)),
+      initial_capital(capital), exclude_sl_from_winrate(exclude_sl) {}
+
+void TradeSimulator::simulate(const std::vector<int>& dir,
+                              const std::vector<double>& sl_percents,
+                              const std::vector<double>& tp_percents,
+                              bool use_sl,
+                              bool use_tp,
+                              bool pyramiding,
+                              size_t first_lane,
+                              size_t lane_count,
+                              MetricsAccumulator* metrics,
+                              std::vector<Trade>* trades,
+                              const BacktestFilter* filter,
+                              const BarRange& range,
+                              LaneState* states,
+                              size_t first_bar) const {
+    typedef void (TradeSimulator::*Kernel)(size_t, size_t, const std::vector<double>&, const std::vector<double>&, size_t,
+                                           size_t, MetricsAccumulator*, std::vector<Trade>*,
+                                           const BacktestFilter*, LaneState*, size_t) const;
+    static const Kernel kernels[8] = {
+        &TradeSimulator::simulateLanes<false, false, false>, &TradeSimulator::simulateLanes<true, false, false>,
+        &TradeSimulator::simulateLanes<false, true, false>, &TradeSimulator::simulateLanes<true, true, false>,
+        &TradeSimulator::simulateLanes<false, false, true>, &TradeSimulator::simulateLanes<true, false, true>,
+        &TradeSimulator::simulateLanes<false, true, true>, &TradeSimulator::simulateLanes<true, true, true>,
+    };
+
+    const size_t end = std::min({dir.size(), closes.size(), range.end});
+    const size_t begin = std::min(range.begin, end);
+    SimulationScratch& scratch = threadScratch();
+
+    // Direction changes are rare, so the signals are collected once and every lane only visits
+    // them; the bars in between are covered by level searches instead of a per-bar loop
+    std::vector<size_t>& signal_index = scratch.signal_index;
+    std::vector<double>& signal_side = scratch.signal_side;
+    signal_index.clear();
+    signal_side.clear();
+    for (size_t i = begin; i < end; ++i) {
+        if (dir[i] != 0 && (i == 0 || dir[i] != dir[i - 1])) {
+            signal_index.push_back(i);
+            signal_side.push_back(dir[i] > 0 ? 1.0 : -1.0);
+        }
+    }
+
+    const Kernel kernel = kernels[(use_sl ? 1 : 0) + (use_tp ? 2 : 0) + (pyramiding ? 4 : 0)];
+    (this->*kernel)(begin, end, sl_percents, tp_percents, first_lane, lane_count, metrics, trades, filter, states,
+                    first_bar);
+}
+
+template <bool UseSL, bool UseTP, bool Pyramiding>
+void TradeSimulator::simulateLanes(size_t begin,
+                                   size_t end,
+                                   const std::vector<double>& sl_percents,
+                                   const std::vector<double>& tp_percents,
+                                   size_t first_lane,
+                                   size_t lane_count,
+                                   MetricsAccumulator* metrics,
+                                   std::vector<Trade>* trades,
+                                   const BacktestFilter* filter,
+                                   LaneState* states,
+                                   size_t first_bar) const {
+    SimulationScratch& scratch = threadScratch();
+    const std::vector<size_t>& signal_index = scratch.signal_index;
+    const std::vector<double>& signal_side = scratch.signal_side;
+    const PriceLevelIndex& index = *level_index;
+    std::vector<OpenPosition>& positions = scratch.positions;
+    std::vector<LevelExit>& exits = scratch.exits;
+
+    for (size_t k = 0; k < lane_count; ++k) {
+        const size_t lane_index = first_lane + k;
+        const double sl_percent = sl_percents[lane_index / tp_percents.size()];
+        const double tp_percent = tp_percents[lane_index % tp_percents.size()];
+        MetricsAccumulator& lane = metrics[k];
+        std::vector<Trade>* lane_trades = trades != nullptr ? &trades[k] : nullptr;
+        lane.reset(initial_capital);
+        positions.clear();
+        size_t next_bar = begin;
+        if (states != nullptr) {
+            lane = states[k].metrics;
+            for (OpenPosition position : states[k].positions) {
+                position.entry_index -= static_cast<int>(first_bar);
+                positions.push_back(position);
+            }
+        }
+
+        // Close every position whose stop or target lies in bars [next_bar, until], in the
+        // order a bar-by-bar scan would: by exit bar, then by entry order. Stops win ties.
+        auto resolveLevels = [&](size_t until) {
+            if constexpr (!UseSL && !UseTP) {
+                return;
+            }
+            if (positions.empty() || next_bar > until) {
+                next_bar = until + 1;
+                return;
+            }
+            exits.clear();
+            for (size_t p = 0; p < positions.size(); ++p) {
+                const OpenPosition& position = positions[p];
+                if constexpr (UseSL && UseTP) {
+                    // Both levels in one pass; on the exit bar the stop wins ties
+                    size_t hit = position.side > 0 ? index.firstOutside(next_bar, until, position.stop, position.target)
+                                                   : index.firstOutside(next_bar, until, position.target, position.stop);
+                    if (hit != PriceLevelIndex::npos) {
+                        bool stopped = position.side > 0 ? lows[hit] <= position.stop : highs[hit] >= position.stop;
+                        exits.push_back({hit, p, stopped});
+                    }
+                } else if constexpr (UseSL) {
+                    size_t hit = position.side > 0 ? index.firstLowAtOrBelow(next_bar, until, position.stop)
+                                                   : index.firstHighAtOrAbove(next_bar, until, position.stop);
+                    if (hit != PriceLevelIndex::npos) {
+                        exits.push_back({hit, p, true});
+                    }
+                } else {
+                    size_t hit = position.side > 0 ? index.firstHighAtOrAbove(next_bar, until, position.target)
+                                                   : index.firstLowAtOrBelow(next_bar, until, position.target);
+                    if (hit != PriceLevelIndex::npos) {
+                        exits.push_back({hit, p, false});
+                    }
+                }
+            }
+            if (!exits.empty()) {
+                // Without pyramiding there is at most one position, hence one exit
+                if constexpr (Pyramiding) {
+                    std::sort(exits.begin(), exits.end(), [](const LevelExit& a, const LevelExit& b) {
+                        return a.bar != b.bar ? a.bar < b.bar : a.position < b.position;
+                    });
+                }
+                for (const auto& exit : exits) {
+                    OpenPosition& position = positions[exit.position];
+                    closeTrade(lane, lane_trades, position, static_cast<int>(exit.bar),
+                               exit.stopped ? position.stop : position.target, exit.stopped ? "SL" : "TP",
+                               exit.stopped, initial_capital);
+                    position.side = 0.0;
+                }
+                positions.erase(std::remove_if(positions.begin(), positions.end(),
+                                               [](const OpenPosition& position) { return position.side == 0.0; }),
+                                positions.end());
+            }
+            next_bar = until + 1;
+        };
+
+        for (size_t s = 0; s < signal_index.size(); ++s) {
+            // Every open position and every remaining signal yields at most one more trade;
+            // stop as soon as even that best case cannot pass the filter
+            if (filter != nullptr) {
+                int future_trades = static_cast<int>(positions.size() + signal_index.size() - s);
+                if (!lane.canStillPass(*filter, future_trades, exclude_sl_from_winrate)) {
+                    lane.prune();
+                    break;
+                }
+            }
+
+            const size_t i = signal_index[s];
+            const double new_side = signal_side[s];
+            const double price = closes[i];
+            resolveLevels(i);
+
+            size_t kept = 0;
+            for (size_t p = 0; p < positions.size(); ++p) {
+                if (positions[p].side == -new_side) {
+                    closeTrade(lane, lane_trades, positions[p], static_cast<int>(i), price, "Signal", false,
+                               initial_capital);
+                } else {
+                    positions[kept++] = positions[p];
+                }
+            }
+            positions.resize(kept);
+
+            // Without pyramiding a signal in the direction already held is ignored
+            if (Pyramiding || positions.empty()) {
+                OpenPosition position = {static_cast<int>(i), price, new_side, 0.0, 0.0};
+                setLevels<UseSL, UseTP>(price, new_side, sl_percent, tp_percent, position.stop, position.target);
+                positions.push_back(position);
+            }
+        }
+
+        // A continued lane may still hold positions when the window brought no new bars; an
+        // empty series has no last bar to close them at
+        if (end > 0 && (end > begin || !positions.empty()) && !lane.pruned()) {
+            resolveLevels(end - 1);
+            if (states != nullptr) {
+                states[k].metrics = lane;
+                states[k].positions.clear();
+                for (OpenPosition position : positions) {
+                    position.entry_index += static_cast<int>(first_bar);
+                    states[k].positions.push_back(position);
+                }
+                states[k].next_bar = first_bar + end;
+            }
+            for (const auto& position : positions) {
+                closeTrade(lane, lane_trades, position, static_cast<int>(end - 1), closes[end - 1], "End", false,
+                           initial_capital);
+            }
+        }
+    }
+}
+
+size_t TradeSimulator::runMetrics(const std::vector<int>& dir,
+                                  const std::vector<double>& sl_percents,
+                                  const std::vector<double>& tp_percents,
+                                  bool use_sl,
+                                  bool use_tp,
+                                  bool pyramiding,
+                                  std::vector<BacktestMetrics>& metrics,
+                                  const BacktestFilter& filter,
+                                  const BarRange& range) const {
+    const size_t lanes = sl_percents.size() * tp_percents.size();
+    std::vector<MetricsAccumulator>& accumulators = threadScratch().lanes;
+    accumulators.resize(lanes);
+    simulate(dir, sl_percents, tp_percents, use_sl, use_tp, pyramiding, 0, lanes, accumulators.data(), nullptr,
+             &filter, range);
+
+    size_t pruned = 0;
+    metrics.resize(lanes);
+    for (size_t k = 0; k < lanes; ++k) {
+        metrics[k] = accumulators[k].metrics(exclude_sl_from_winrate);
+        pruned += metrics[k].pruned ? 1 : 0;
+    }
+    return pruned;
+}
+
+bool TradeSimulator::continueMetrics(const std::vector<int>& dir,
+                                     const std::vector<double>& sl_percents,
+                                     const std::vector<double>& tp_percents,
+                                     bool use_sl,
+                                     bool use_tp,
+                                     bool pyramiding,
+                                     std::vector<LaneState>& states,
+                                     std::vector<BacktestMetrics>& metrics,
+                                     size_t first_bar) const {
+    const size_t lanes = sl_percents.size() * tp_percents.size();
+    const size_t end = std::min(dir.size(), closes.size());
+    if (states.size() != lanes) {
+        std::cerr << "Cannot continue " << lanes << " lanes from " << states.size() << " saved states" << std::endl;
+        return false;
+    }
+    if (end == 0) {
+        std::cerr << "Cannot continue saved lanes over an empty series" << std::endl;
+        return false;
+    }
+
+    // Every lane of a run stops at the same bar
+    const uint64_t next_bar = lanes > 0 ? states[0].next_bar : first_bar;
+    for (const auto& state : states) {
+        if (state.next_bar != next_bar || state.next_bar < first_bar || state.next_bar > first_bar + end) {
+            std::cerr << "Saved lane state at bar " << state.next_bar << " lies outside bars " << first_bar << "-"
+                      << first_bar + end << std::endl;
+            return false;
+        }
+    }
+
+    BarRange range;
+    range.begin = static_cast<size_t>(next_bar - first_bar);
+    std::vector<MetricsAccumulator>& accumulators = threadScratch().lanes;
+    accumulators.resize(lanes);
+    simulate(dir, sl_percents, tp_percents, use_sl, use_tp, pyramiding, 0, lanes, accumulators.data(), nullptr,
+             nullptr, range, states.data(), first_bar);
+
+    metrics.resize(lanes);
+    for (size_t k = 0; k < lanes; ++k) {
+        metrics[k] = accumulators[k].metrics(exclude_sl_from_winrate);
+    }
+    return true;
+}
+
+BacktestResult TradeSimulator::replay(const std::vector<int>& dir,
+                                      double sl_percent,
+                                      double tp_percent,
+                                      bool use_sl,
+                                      bool use_tp,
+                                      bool pyramiding,
+                                      const BarRange& range) const {
+    const std::vector<double> sl_percents(1, sl_percent);
+    const std::vector<double> tp_percents(1, tp_percent);
+    MetricsAccumulator accumulator(initial_capital);
+    BacktestResult result;
+    simulate(dir, sl_percents, tp_percents, use_sl, use_tp, pyramiding, 0, 1, &accumulator, &result.trades,
+             nullptr, range);
+    accumulator.metrics(exclude_sl_from_winrate).applyTo(result);
+    return result;
+}
+
+std::vector<BacktestResult> TradeSimulator::run(const std::vector<int>& dir,
+                                                const std::vector<double>& sl_percents,
+                                                const std::vector<double>& tp_percents,
+                                                bool use_sl,
+                                                bool use_tp,
+                                                bool pyramiding) const {
+    const size_t lanes = sl_percents.size() * tp_percents.size();
+    std::vector<MetricsAccumulator> accumulators(lanes);
+    std::vector<std::vector<Trade>> trades(lanes);
+    simulate(dir, sl_percents, tp_percents, use_sl, use_tp, pyramiding, 0, lanes, accumulators.data(), trades.data(),
+             nullptr, BarRange());
+
+    std::vector<BacktestResult> results(lanes);
+    for (size_t k = 0; k < lanes; ++k) {
+        accumulators[k].metrics(exclude_sl_from_winrate).applyTo(results[k]);
+        results[k].trades = std::move(trades[k]);
+    }
+    return results;
+}
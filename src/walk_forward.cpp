@@ -0,0 +1,146 @@
+#include "walk_forward.h"
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+// An in-sample (variant, SL/TP lane) result competing for a window's top K
+struct WindowCandidate {
+    double score;
+    uint64_t tie;       // Key hash, so equal scores rank the same way on every run
+    std::size_t variant;
+    std::size_t lane;
+    BacktestMetrics metrics;
+};
+
+static bool betterCandidate(const WindowCandidate& a, const WindowCandidate& b) {
+    return a.score != b.score ? a.score > b.score : a.tie < b.tie;
+}
+
+// Keep the best `top_k` of `candidates`; trimming only once the list doubles keeps it amortized O(1)
+static void trimCandidates(std::vector<WindowCandidate>& candidates, std::size_t top_k, bool force) {
+    if (candidates.size() > top_k && (force || candidates.size() >= 2 * top_k)) {
+        std::nth_element(candidates.begin(), candidates.begin() + top_k, candidates.end(), betterCandidate);
+        candidates.resize(top_k);
+    }
+}
+
+ParamKey laneKey(ParamKey key, std::size_t lane, std::size_t tp_count, bool use_sl, bool use_tp, bool pyramiding) {
+    key.flags = (use_sl ? ParamKey::USE_SL : 0) | (use_tp ? ParamKey::USE_TP : 0) | (pyramiding ? ParamKey::PYRAMIDING : 0);
+    // Grids too wide for SL and TP are rejected up front (ParamGrid::fitsParamKey)
+    if (key.dimensions + 2 <= ParamKey::MAX_DIMENSIONS) {
+        key.index[key.dimensions++] = static_cast<uint16_t>(lane / tp_count);
+        key.index[key.dimensions++] = static_cast<uint16_t>(lane % tp_count);
+    }
+    return key;
+}
+
+WalkForwardEngine::WalkForwardEngine(const TradeSimulator& trade_simulator,
+                                     const std::vector<double>& sl_pcts,
+                                     const std::vector<double>& tp_pcts,
+                                     bool enable_sl,
+                                     bool enable_tp,
+                                     bool enable_pyramiding)
+    : simulator(trade_simulator), sl_percents(sl_pcts), tp_percents(tp_pcts),
+      use_sl(enable_sl), use_tp(enable_tp), pyramiding(enable_pyramiding) {}
+
+std::vector<WalkForwardWindow> WalkForwardEngine::layout(std::size_t bars, const WalkForwardConfig& config) {
+    std::vector<WalkForwardWindow> windows;
+    const std::size_t step = config.step_bars > 0 ? config.step_bars : config.out_of_sample_bars;
+    if (config.in_sample_bars == 0 || config.out_of_sample_bars == 0) {
+        return windows;
+    }
+    for (std::size_t start = 0; start + config.in_sample_bars + config.out_of_sample_bars <= bars; start += step) {
+        WalkForwardWindow window;
+        window.in_sample = {start, start + config.in_sample_bars};
+        window.out_of_sample = {window.in_sample.end, window.in_sample.end + config.out_of_sample_bars};
+        windows.push_back(window);
+    }
+    return windows;
+}
+
+std::vector<WalkForwardWindow> WalkForwardEngine::run(std::size_t bars,
+                                                      const WalkForwardConfig& config,
+                                                      std::size_t variant_count,
+                                                      const VariantKey& variant_key,
+                                                      const SignalSource& signals,
+                                                      ThreadPool& pool) const {
+    std::vector<WalkForwardWindow> windows = layout(bars, config);
+    const std::size_t lanes = sl_percents.size() * tp_percents.size();
+    if (windows.empty() || lanes == 0 || config.top_k == 0) {
+        std::cerr << "Walk-forward: no complete window of " << config.in_sample_bars << " + "
+                  << config.out_of_sample_bars << " bars in " << bars << " bars" << std::endl;
+        return std::vector<WalkForwardWindow>();
+    }
+
+    // In-sample: each variant's directions are built once and every window simulates its own
+    // range of them. Each task keeps its own top K per window and merges them once at the end.
+    // Variants that share a key (see optimize()) are the same combination; only the first
+    // claimed competes, so it cannot fill several picks.
+    std::vector<std::vector<WindowCandidate>> best(windows.size());
+    std::mutex best_mutex;
+    ResultCollector unique(variant_count);
+    parallelFor(variant_count, 1, [&](std::size_t begin, std::size_t end) {
+        std::vector<std::vector<WindowCandidate>> local(windows.size());
+        std::vector<int> dir;
+        std::vector<BacktestMetrics> metrics;
+        for (std::size_t variant = begin; variant < end; ++variant) {
+            const ParamKey key = variant_key(variant);
+            if (!unique.claim(key) || !signals(variant, dir)) {
+                continue;
+            }
+            for (std::size_t w = 0; w < windows.size(); ++w) {
+                simulator.runMetrics(dir, sl_percents, tp_percents, use_sl, use_tp, pyramiding, metrics,
+                                     config.filter, windows[w].in_sample);
+                for (std::size_t lane = 0; lane < lanes; ++lane) {
+                    if (!config.filter.passes(metrics[lane])) {
+                        continue;
+                    }
+                    uint64_t tie = laneKey(key, lane, tp_percents.size(), use_sl, use_tp, pyramiding).hash();
+                    local[w].push_back({rankingValue(metrics[lane], config.metric), tie, variant, lane, metrics[lane]});
+                    trimCandidates(local[w], config.top_k, false);
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(best_mutex);
+        for (std::size_t w = 0; w < windows.size(); ++w) {
+            trimCandidates(local[w], config.top_k, true);
+            best[w].insert(best[w].end(), local[w].begin(), local[w].end());
+            trimCandidates(best[w], config.top_k, true);
+        }
+    }, pool);
+
+    // Out of sample: the winners, grouped by variant so each direction vector is built once more
+    std::vector<std::vector<std::pair<std::size_t, std::size_t>>> picks_of(variant_count);
+    for (std::size_t w = 0; w < windows.size(); ++w) {
+        std::sort(best[w].begin(), best[w].end(), betterCandidate);
+        windows[w].picks.resize(best[w].size());
+        for (std::size_t p = 0; p < best[w].size(); ++p) {
+            picks_of[best[w][p].variant].push_back(std::make_pair(w, p));
+        }
+    }
+    parallelFor(variant_count, 1, [&](std::size_t begin, std::size_t end) {
+        std::vector<int> dir;
+        std::vector<BacktestMetrics> metrics;
+        for (std::size_t variant = begin; variant < end; ++variant) {
+            if (picks_of[variant].empty() || !signals(variant, dir)) {
+                continue;
+            }
+            const ParamKey key = variant_key(variant);
+            for (const auto& pick_index : picks_of[variant]) {
+                const WindowCandidate& candidate = best[pick_index.first][pick_index.second];
+                const std::vector<double> sl(1, sl_percents[candidate.lane / tp_percents.size()]);
+                const std::vector<double> tp(1, tp_percents[candidate.lane % tp_percents.size()]);
+                simulator.runMetrics(dir, sl, tp, use_sl, use_tp, pyramiding, metrics, BacktestFilter(),
+                                     windows[pick_index.first].out_of_sample);
+
+                WalkForwardPick& pick = windows[pick_index.first].picks[pick_index.second];
+                pick.key = laneKey(key, candidate.lane, tp_percents.size(), use_sl, use_tp, pyramiding);
+                pick.in_sample = candidate.metrics;
+                pick.out_of_sample = metrics[0];
+            }
+        }
+    }, pool);
+
+    return windows;
+}